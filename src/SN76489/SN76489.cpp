@@ -1,5 +1,10 @@
 #include "SN76489.h"
 
+const int16_t SN76489::volumeTable[16] {
+    8191, 6506, 5168, 4105, 3261, 2590, 2057, 1634,
+    1298, 1031, 819, 651, 517, 411, 326, 0
+};
+
 SN76489::SN76489() {
 
     // Initialize all muted
@@ -12,6 +17,7 @@ SN76489::SN76489() {
     outputNoise = 0;
     latchChannel = 0;
     latchType = 0;
+    stereo = 0xFF;
 }
 
 void SN76489::write(uint8_t byte) {
@@ -95,59 +101,131 @@ void SN76489::cycle() {
         counter[3] --;
 
     }else if(counter[3] == 0) {
-        uint8_t noise = (reg[3] & 0b0000000000000100) >> 2;
-        uint8_t reset = reg[3] & 0b0000000000000011;
-
-        // Reset value
-        switch(reset) {
-            case 0: counter[3] = 0x10; break;
-            case 1: counter[3] = 0x20; break;
-            case 2: counter[3] = 0x40; break;
-            case 3: counter[3] = (reg[2] & 0b0000001111111111); break;
+        reloadNoise();
+    }
+}
+
+void SN76489::reloadNoise() {
+    uint8_t noise = (reg[3] & 0b0000000000000100) >> 2;
+    uint8_t reset = reg[3] & 0b0000000000000011;
+
+    // Reset value
+    switch(reset) {
+        case 0: counter[3] = 0x10; break;
+        case 1: counter[3] = 0x20; break;
+        case 2: counter[3] = 0x40; break;
+        case 3: counter[3] = (reg[2] & 0b0000001111111111); break;
+    }
+    output[3] *= -1;
+
+    if(output[3] == 1) {
+        uint16_t in = 0;
+
+        outputNoise = (linearFeedback & 1);
+
+        // White Noise
+        if(noise == 1) {
+            uint8_t bit1 = (linearFeedback & (1 << 0)) ? 1 : 0;
+            uint8_t bit2 = (linearFeedback & (1 << 3)) ? 1 : 0;
+            
+            if(bit1 ^ bit2)
+                in = (1 << 15);
+
+        // Periodic Noise
+        }else {
+            
+            if(linearFeedback & 1)
+                in = (1 << 15);
         }
-        output[3] *= -1;
+        linearFeedback = in | (linearFeedback >> 1);
+    }
+}
+
+void SN76489::advance(int count) {
 
-        if(output[3] == 1) {
-            uint16_t in = 0;
+    // Tones flip once the counter passes zero, then every tone+1 cycles
+    for(int i = 0; i < 3; i ++) {
+        int tone = (reg[i] & 0b0000001111111111);
 
-            outputNoise = (linearFeedback & 1);
+        if(count <= counter[i]) {
+            counter[i] -= count;
 
-            // White Noise
-            if(noise == 1) {
-                uint8_t bit1 = (linearFeedback & (1 << 0)) ? 1 : 0;
-                uint8_t bit2 = (linearFeedback & (1 << 3)) ? 1 : 0;
-                
-                if(bit1 ^ bit2)
-                    in = (1 << 15);
+        }else {
+            int remaining = count - counter[i] - 1;
+            int flips = 1 + remaining / (tone + 1);
 
-            // Periodic Noise
-            }else {
-                
-                if(linearFeedback & 1)
-                    in = (1 << 15);
-            }
-            linearFeedback = in | (linearFeedback >> 1);
+            counter[i] = tone - remaining % (tone + 1);
+
+            if(flips & 1)
+                output[i] *= -1;
         }
     }
+
+    // Noise steps the shift register on every reload
+    int remaining = count;
+
+    while(remaining > counter[3]) {
+        remaining -= counter[3] + 1;
+        reloadNoise();
+    }
+    counter[3] -= remaining;
 }
 
-float SN76489::getSample() {
-    float mix = 0.f;
+int16_t SN76489::getSample() {
+    int mix = 0;
     
     // Tones
     for(int i = 0; i < 3; i ++) {
         uint8_t volume    = (reg[i] & 0b1111000000000000) >> 12;
-        uint16_t tone     = (reg[i] & 0b0000001111111111);
 
         if(counter[i] > 0)
-            mix += output[i] * (1.0f - volume / 15.f);
+            mix += output[i] * volumeTable[volume];
     }
 
     // Noise
     if(counter[3] > 0) {
         uint8_t volume = (reg[3] & 0b1111000000000000) >> 12;
-        mix += outputNoise * (1.0f - volume / 15.f);
+        mix += outputNoise * volumeTable[volume];
+    }
+
+    return mix;
+}
+
+void SN76489::render(int16_t* buffer, int count) {
+    const int blockSize = 256;
+
+    // Volume and stereo registers only change between blocks
+    int16_t amplitude[4];
+    int16_t left[4];
+    int16_t right[4];
+
+    for(int i = 0; i < 4; i ++) {
+        amplitude[i] = volumeTable[(reg[i] & 0b1111000000000000) >> 12];
+        left[i] = (stereo & (0b00010000 << i)) ? -1 : 0;
+        right[i] = (stereo & (0b00000001 << i)) ? -1 : 0;
     }
 
-    return mix / 4.f;
+    int16_t channel[4][blockSize];
+
+    for(int start = 0; start < count; start += blockSize) {
+        int size = (count - start < blockSize) ? count - start : blockSize;
+
+        // Step the generators, storing each channels level
+        for(int n = 0; n < size; n ++) {
+            cycle();
+
+            for(int i = 0; i < 3; i ++)
+                channel[i][n] = (counter[i] > 0) ? output[i] * amplitude[i] : 0;
+
+            channel[3][n] = (counter[3] > 0) ? outputNoise * amplitude[3] : 0;
+        }
+
+        // Mix the channels masked per side, simple enough for the compiler to vectorize
+        int16_t* out = buffer + start * 2;
+
+        for(int n = 0; n < size; n ++) {
+            out[n*2+0] = (channel[0][n] & left[0]) + (channel[1][n] & left[1]) + (channel[2][n] & left[2]) + (channel[3][n] & left[3]);
+            out[n*2+1] = (channel[0][n] & right[0]) + (channel[1][n] & right[1]) + (channel[2][n] & right[2]) + (channel[3][n] & right[3]);
+        }
+    }
 }
\ No newline at end of file
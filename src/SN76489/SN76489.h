@@ -16,9 +16,22 @@ struct SN76489 {
     uint8_t latchChannel;
     uint8_t latchType;
 
+    // Game Gear stereo enables, bits 0-3 right and bits 4-7 left for channels 0-3
+    uint8_t stereo;
+
+    // Attenuation of each 4bit volume setting, 2dB steps with headroom to mix 4 channels
+    static const int16_t volumeTable[16];
+
     void write(uint8_t byte);
     void cycle();
-    float getSample();
+    void reloadNoise();
+    int16_t getSample();
+
+    // Same as cycling count times, for frames that are never heard
+    void advance(int count);
+
+    // Cycle and mix a whole block of interleaved left/right frames at once
+    void render(int16_t* buffer, int count);
 };
 
 #endif
\ No newline at end of file
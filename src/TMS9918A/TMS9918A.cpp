@@ -1,8 +1,19 @@
 #include "TMS9918A.h"
 #include "utilities.h"
+#include <cstring>
+#include <algorithm>
+#include <climits>
 
 TMS9918A::TMS9918A() {
     controlOffset = 0;
+    controlWord = 0;
+    readBuffer = 0;
+    status = 0;
+
+    std::memset(vram, 0, sizeof(vram));
+    std::memset(cram, 0, sizeof(cram));
+    std::memset(frameBuffer, 0, sizeof(frameBuffer));
+    std::memset(depthBuffer, 0, sizeof(depthBuffer));
 
     requestFrameInterrupt = false;
     requestLineInterrupt = false;
@@ -13,10 +24,13 @@ TMS9918A::TMS9918A() {
     hCounter = 0;
     vCounter = 0;
     hCounterBuffer = 0;
+    lineCounter = 0;
 
     mode = 4;
 
     videoFormat = MASTERSYSTEM_NTSC;
+
+    renderEnable = true;
 }
 
 void TMS9918A::writeControlPort(uint8_t data) {
@@ -349,6 +363,82 @@ uint16_t TMS9918A::getHCounterLimit(){
     return 342;
 }
 
+int TMS9918A::getEventTicks() {
+    int hLimit = getHCounterLimit();
+
+    int draw = (getActiveDisplayWidth() - hCounter + hLimit) % hLimit;
+
+    if(draw == 0)
+        draw = hLimit;
+
+    int frameEnd = hLimit - hCounter + (getVCounterLimit() - 1 - vCounter) * hLimit;
+
+    return std::max(1, std::min(draw, frameEnd));
+}
+
+int TMS9918A::getInterruptTicks() {
+    bool enableLineInterrupts   = reg[0x0] & 0b00010000;
+    bool enableFrameInterrupts  = reg[0x1] & 0b00100000;
+
+    if(!enableLineInterrupts && !enableFrameInterrupts)
+        return INT_MAX;
+
+    int hLimit = getHCounterLimit();
+    int vLimit = getVCounterLimit();
+    int height = getActiveDisplayHeight();
+
+    // Counters left out of range by a format change wrap on the next tick
+    if(vCounter >= vLimit)
+        return 1;
+
+    // Requests are made where the scanline is drawn, the next draw is on this line or the one after
+    int ticks = (getActiveDisplayWidth() - hCounter + hLimit) % hLimit;
+    int line = vCounter;
+    int counter = lineCounter;
+
+    if(hCounter >= getActiveDisplayWidth()) {
+        line ++;
+
+        if(line >= vLimit) {
+            line = 0;
+            counter = reg[0xA];
+        }
+    }
+
+    if(ticks == 0)
+        ticks = hLimit;
+
+    int lines = INT_MAX;
+
+    if(enableFrameInterrupts)
+        lines = (height - 1 - line + vLimit) % vLimit;
+
+    // The line counter runs out within the active display, or starts over from the end of the frame
+    if(enableLineInterrupts) {
+
+        if(line <= height && line + counter <= height) {
+            lines = std::min(lines, counter);
+
+        }else if(reg[0xA] <= height) {
+            lines = std::min(lines, vLimit - line + reg[0xA]);
+        }
+    }
+
+    if(lines == INT_MAX)
+        return INT_MAX;
+
+    return ticks + lines * hLimit;
+}
+
+void TMS9918A::advance(int ticks) {
+    hCounter += ticks;
+
+    if(hCounter >= getHCounterLimit()) {
+        hCounter -= getHCounterLimit();
+        vCounter ++;
+    }
+}
+
 uint16_t TMS9918A::getVCounterLimit(){
 
     // NTSC
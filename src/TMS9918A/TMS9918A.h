@@ -64,6 +64,15 @@ struct TMS9918A {
     uint16_t getHCounterLimit();
     uint16_t getVCounterLimit();
 
+    // Ticks until the next scanline is drawn or the frame ends, whichever comes first
+    int getEventTicks();
+
+    // Moves the counters on by fewer ticks than getEventTicks(), nothing else happens on the way
+    void advance(int ticks);
+
+    // Ticks until an enabled line or frame interrupt is next requested, INT_MAX while neither is enabled
+    int getInterruptTicks();
+
     /* TV screen sizes */
     uint16_t getScreenWidth();
     uint16_t getScreenHeight();
@@ -77,7 +86,12 @@ struct TMS9918A {
     uint16_t getSpriteTableSize();
 
     int frameBuffer[256 * 313];
-    int depthBuffer[256 * 313];
+
+    // Draw mode behind every pixel, a byte each as every frame goes through the whole buffer
+    uint8_t depthBuffer[256 * 313];
+
+    // Cleared to skip drawing the picture, sprites are still evaluated for the status flags
+    bool renderEnable;
 
     void drawScanLine();
     bool drawPixel(int x, int y, int color, int depth, bool force = false);
@@ -8,16 +8,21 @@ void TMS9918A::drawScanLine() {
     // Reset line
     uint8_t bgPalette = reg[0x7] + 16;
 
-    if(vCounter < getActiveDisplayHeight()) {
+    if(renderEnable && vCounter < getActiveDisplayHeight()) {
 
-        for(int x = 0; x < 256; x ++) {
+        for(int x = 0; x < 256; x ++)
             frameBuffer[x + vCounter * 256] = getColor(bgPalette);
-            depthBuffer[x + vCounter * 256] = CLEAR;
-        }
     }
 
+    // Depth only lives for the line, so sprite collisions never depend on a previous frame
+    for(int x = 0; x < 256; x ++)
+        depthBuffer[x + vCounter * 256] = CLEAR;
+
     drawSprites();
-    drawTilemap();
+
+    // Frames that are not shown only evaluate sprites, for the collision and overflow flags
+    if(renderEnable)
+        drawTilemap();
 }
 
 bool TMS9918A::drawPixel(int x, int y, int color, int depth, bool force) {
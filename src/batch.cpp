@@ -0,0 +1,179 @@
+#include "sms.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <filesystem>
+#include <cctype>
+
+struct BatchResult {
+    std::string status;
+    int frames = 0;
+    double seconds = 0;
+    uint64_t hash = 0;
+    int invalidOpcodeAddress = -1;
+    uint8_t invalidOpcode[4] {};
+};
+
+static bool isRomFile(const std::filesystem::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    return ext == ".sms" || ext == ".gg" || ext == ".sg";
+}
+
+static void runRom(std::string path, int frames, BatchResult& result) {
+
+    // Each rom gets its own machine, nothing is shared between threads
+    std::unique_ptr<sms> emu = std::make_unique<sms>();
+    emu->debugConsole = NULL;
+
+    if(!emu->loadRom(path)) {
+        result.status = "load-error";
+        return;
+    }
+    result.status = "ok";
+
+    auto start = std::chrono::steady_clock::now();
+
+    try {
+
+        while(result.frames < frames) {
+            emu->update();
+            result.frames ++;
+        }
+
+    }catch(std::exception& e) {
+        result.status = (emu->invalidOpcodeAddress >= 0) ? "invalid-opcode" : "error";
+        result.invalidOpcodeAddress = emu->invalidOpcodeAddress;
+        std::copy(emu->invalidOpcode, emu->invalidOpcode + 4, result.invalidOpcode);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    result.hash = emu->getFrameHash();
+}
+
+static void writeResult(std::ostream& out, const std::string& path, const BatchResult& result) {
+    out << path << "," << result.status << "," << std::dec << result.frames << ",";
+    out << (result.seconds > 0 ? result.frames / result.seconds : 0) << ",";
+    out << std::hex << result.hash << ",";
+
+    if(result.invalidOpcodeAddress >= 0) {
+        out << result.invalidOpcodeAddress << ",";
+
+        for(int i = 0; i < 4; i ++)
+            out << (i ? " " : "") << (int)result.invalidOpcode[i];
+
+    }else {
+        out << ",";
+    }
+    out << std::dec << "\n";
+}
+
+int main(int argc, char* argv[]) {
+
+    // Batch options
+    int         optionFrames = 600;
+    int         optionThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::string optionOutputPath;
+    std::vector<std::string> roms;
+
+    for(int i = 1; i < argc; i ++) {
+        std::string option = argv[i];
+
+        if(option == "--help") {
+            std::cout << "sms-batch [options] roms or directories...\n";
+            std::cout << "\t--frames <count>\tNumber of frames to emulate per rom\n";
+            std::cout << "\t--threads <count>\tNumber of roms run at once, the core count by default\n";
+            std::cout << "\t--output <file>\t\tWrites the results to a csv file instead of stdout\n";
+            return 0;
+
+        }else if(option == "--frames" || option == "-n") {
+            i ++;
+            if(i < argc) optionFrames = std::max(0, std::stoi(argv[i]));
+
+        }else if(option == "--threads" || option == "-j") {
+            i ++;
+            if(i < argc) optionThreads = std::max(1, std::stoi(argv[i]));
+
+        }else if(option == "--output") {
+            i ++;
+            if(i < argc) optionOutputPath = argv[i];
+
+        }else if(std::filesystem::is_directory(option)) {
+            std::vector<std::string> found;
+
+            for(auto& entry : std::filesystem::recursive_directory_iterator(option)) {
+
+                if(entry.is_regular_file() && isRomFile(entry.path()))
+                    found.push_back(entry.path().string());
+            }
+            std::sort(found.begin(), found.end());
+            roms.insert(roms.end(), found.begin(), found.end());
+
+        }else {
+            roms.push_back(option);
+        }
+    }
+
+    if(roms.empty()) {
+        std::cerr << "No roms given\n";
+        return 1;
+    }
+
+    // Workers pull the next rom until the list runs out
+    std::vector<BatchResult> results(roms.size());
+    std::atomic<size_t> next = 0;
+
+    auto worker = [&]() {
+        size_t index;
+
+        while((index = next.fetch_add(1)) < roms.size())
+            runRom(roms[index], optionFrames, results[index]);
+    };
+
+    std::vector<std::thread> threads;
+    int count = std::min<size_t>(optionThreads, roms.size());
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(int i = 0; i < count; i ++)
+        threads.emplace_back(worker);
+
+    for(std::thread& thread : threads)
+        thread.join();
+
+    auto end = std::chrono::steady_clock::now();
+
+    // Results keep the order the roms were given in
+    std::fstream file;
+
+    if(!optionOutputPath.empty()) {
+        file.open(optionOutputPath, std::fstream::out | std::fstream::trunc);
+
+        if(!file.good()) {
+            std::cerr << "Error opening the output file\n";
+            return 1;
+        }
+    }
+    std::ostream& out = (file.is_open()) ? file : std::cout;
+
+    out << "rom,status,frames,fps,hash,invalid_pc,invalid_opcode\n";
+
+    int failures = 0;
+
+    for(size_t i = 0; i < roms.size(); i ++) {
+        writeResult(out, roms[i], results[i]);
+
+        if(results[i].status != "ok")
+            failures ++;
+    }
+
+    std::cerr << roms.size() << " roms, " << failures << " failed, " << std::chrono::duration<double>(end - start).count() << " seconds\n";
+
+    return (failures > 0) ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,269 @@
+#include "sms.h"
+#include "wav.h"
+#include "movie.h"
+#include "hotspots.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+
+int main(int argc, char* argv[]) {
+
+    // Emulator options
+    int         optionRomPath = 0;
+    int         optionFrames = -1;
+    int         optionUntilPC = -1;
+    std::string optionWavPath;
+    std::string optionLoadState;
+    std::string optionSaveState;
+    std::string optionMoviePath;
+    std::string optionSramPath;
+    std::string optionHotspotsPath;
+    std::string optionStacksPath;
+    bool        optionCheckJIT = false;
+
+    for(int i = 1; i < argc; i ++) {
+        std::string option = argv[i];
+
+        if(option == "--help") {
+            std::cout << "sms-headless [options] program\n";
+            std::cout << "\t--frames <count>\tNumber of frames to emulate\n";
+            std::cout << "\t--until-pc <address>\tStop once the program counter reaches a hex address\n";
+            std::cout << "\t--wav <file>\t\tCaptures the audio output to a wav file\n";
+            std::cout << "\t--load-state <file>\tStarts from a save state\n";
+            std::cout << "\t--save-state <file>\tWrites a save state once finished\n";
+            std::cout << "\t--play <file>\t\tReplays the inputs of a movie file\n";
+            std::cout << "\t--sram <file>\t\tKeeps the cartridge ram in a save file\n";
+#ifdef Z80_PROFILE
+            std::cout << "\t--hotspots <file>\tWrites the rom addresses taking the most cycles\n";
+            std::cout << "\t--stacks <file>\t\tWrites the cycles of every call stack for flame graphs\n";
+#endif
+#ifdef Z80_JIT
+            std::cout << "\t--check-jit\t\tRuns the interpreter alongside, stopping at the first frame that differs\n";
+#endif
+            return 0;
+
+        }else if(option == "--frames" || option == "-n") {
+            i ++;
+            if(i < argc) optionFrames = std::max(0, std::stoi(argv[i]));
+
+        }else if(option == "--until-pc") {
+            i ++;
+            if(i < argc) optionUntilPC = std::stoi(argv[i], NULL, 16) & 0xFFFF;
+
+        }else if(option == "--wav") {
+            i ++;
+            if(i < argc) optionWavPath = argv[i];
+
+        }else if(option == "--load-state") {
+            i ++;
+            if(i < argc) optionLoadState = argv[i];
+
+        }else if(option == "--save-state") {
+            i ++;
+            if(i < argc) optionSaveState = argv[i];
+
+        }else if(option == "--play") {
+            i ++;
+            if(i < argc) optionMoviePath = argv[i];
+
+        }else if(option == "--sram") {
+            i ++;
+            if(i < argc) optionSramPath = argv[i];
+
+#ifdef Z80_PROFILE
+        }else if(option == "--hotspots") {
+            i ++;
+            if(i < argc) optionHotspotsPath = argv[i];
+
+        }else if(option == "--stacks") {
+            i ++;
+            if(i < argc) optionStacksPath = argv[i];
+#endif
+
+#ifdef Z80_JIT
+        }else if(option == "--check-jit") {
+            optionCheckJIT = true;
+#endif
+
+        }else {
+            optionRomPath = i;
+        }
+    }
+
+    if(optionRomPath == 0) {
+        std::cerr << "No rom given\n";
+        return 1;
+    }
+
+    // Initialize the emulator
+    sms emu;
+
+    if(!emu.loadRom(argv[optionRomPath])) {
+        std::cerr << "Error loading the rom\n";
+        return 1;
+    }
+    emu.breakpoint = optionUntilPC;
+
+    if(!optionSramPath.empty() && !emu.loadSram(optionSramPath)) {
+        std::cerr << "Error opening the save file\n";
+        return 1;
+    }
+
+    if(!optionLoadState.empty() && !emu.loadStateFile(optionLoadState)) {
+        std::cerr << "Error loading the state\n";
+        return 1;
+    }
+
+    // Movies bring their own starting point and inputs
+    Movie movie;
+
+    if(!optionMoviePath.empty()) {
+
+        if(!movie.play(optionMoviePath, emu)) {
+            std::cerr << "Error loading the movie\n";
+            return 1;
+        }
+        emu.movie = &movie;
+
+        if(optionFrames < 0)
+            optionFrames = movie.getFrameCount();
+    }
+
+    if(optionFrames < 0)
+        optionFrames = 600;
+
+    // The same machine without compiled blocks, both have to agree after every frame
+    std::unique_ptr<sms> reference;
+    Movie referenceMovie;
+
+    if(optionCheckJIT) {
+
+        if(!optionSramPath.empty()) {
+            std::cerr << "The jit check can not share a save file\n";
+            return 1;
+        }
+        reference = std::make_unique<sms>();
+        reference->debugConsole = NULL;
+
+#ifdef Z80_JIT
+        reference->cpu.jitEnabled = false;
+#endif
+
+        bool loaded = reference->loadRom(argv[optionRomPath]);
+
+        if(loaded && !optionLoadState.empty())
+            loaded = reference->loadStateFile(optionLoadState);
+
+        if(loaded && !optionMoviePath.empty()) {
+            loaded = referenceMovie.play(optionMoviePath, *reference);
+            reference->movie = &referenceMovie;
+        }
+
+        if(!loaded) {
+            std::cerr << "Error loading the interpreter machine\n";
+            return 1;
+        }
+        reference->breakpoint = optionUntilPC;
+    }
+
+    WavWriter capture;
+
+    if(!optionWavPath.empty()) {
+
+        if(!capture.open(optionWavPath, 2, emu.getAudioFrequency())) {
+            std::cerr << "Error opening the wav file\n";
+            return 1;
+        }
+        emu.audioCapture = &capture;
+    }
+
+#ifdef Z80_PROFILE
+    Hotspots hotspots;
+
+    if(!optionHotspotsPath.empty() || !optionStacksPath.empty())
+        hotspots.attach(emu);
+#endif
+
+    // Run as fast as possible, without video or audio output
+    std::clog.setstate(std::iostream::failbit);
+
+    int frames = 0;
+    int status = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    try {
+
+        while(frames < optionFrames) {
+            emu.update();
+
+            if(reference) {
+                reference->update();
+
+                if(reference->getFrameHash() != emu.getFrameHash() || std::memcmp(reference->ram, emu.ram, sizeof(emu.ram)) != 0) {
+                    std::cerr << "Compiled blocks differ from the interpreter at frame " << frames << "\n";
+                    status = 1;
+                    break;
+                }
+            }
+            frames ++;
+
+            if(emu.breakpointHit)
+                break;
+        }
+
+    }catch(std::exception& e) {
+        std::cerr << e.what() << "\n";
+        status = 1;
+
+        if(emu.invalidOpcodeAddress >= 0) {
+            std::cerr << std::hex << emu.invalidOpcodeAddress << ":";
+
+            for(int i = 0; i < 4; i ++)
+                std::cerr << " " << (int)emu.invalidOpcode[i];
+
+            std::cerr << std::dec << "\n";
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    capture.close();
+
+    if(!optionSaveState.empty() && !emu.saveStateFile(optionSaveState)) {
+        std::cerr << "Error saving the state\n";
+        status = 1;
+    }
+
+    std::cout << "frames: " << std::dec << frames << "\n";
+    std::cout << "seconds: " << seconds << "\n";
+    std::cout << "fps: " << (seconds > 0 ? frames / seconds : 0) << "\n";
+    std::cout << "hash: " << std::hex << emu.getFrameHash() << std::dec << "\n";
+
+#ifdef Z80_PROFILE
+    emu.cpu.writeProfile(std::cerr);
+
+    if(!optionHotspotsPath.empty()) {
+        std::fstream file(optionHotspotsPath, std::fstream::out | std::fstream::trunc);
+        hotspots.writeReport(file);
+
+        if(!file.good()) {
+            std::cerr << "Error writing the hotspots\n";
+            status = 1;
+        }
+    }
+
+    if(!optionStacksPath.empty()) {
+        std::fstream file(optionStacksPath, std::fstream::out | std::fstream::trunc);
+        hotspots.writeStacks(file);
+
+        if(!file.good()) {
+            std::cerr << "Error writing the call stacks\n";
+            status = 1;
+        }
+    }
+#endif
+
+    return status;
+}
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "hotspots.h"
+#include "sms.h"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+
+using namespace std::placeholders;
+
+Hotspots::Hotspots() {
+    nodes.push_back({ Location_Root, -1, 0 });
+    stack.push_back(0);
+
+    emu = NULL;
+    lastLocation = Location_Root;
+    nextPC = -1;
+}
+
+Hotspots::~Hotspots() {
+    detach();
+}
+
+void Hotspots::attach(sms& emu) {
+    detach();
+
+    this->emu = &emu;
+    emu.hotspots = this;
+    emu.cpu.instructionHook = std::bind(&Hotspots::instruction, this, _1, _2, _3);
+}
+
+void Hotspots::detach() {
+
+    if(emu) {
+        emu->hotspots = NULL;
+        emu->cpu.instructionHook = nullptr;
+        emu = NULL;
+    }
+}
+
+uint32_t Hotspots::locate(uint16_t addr) {
+
+    // System ram and its mirror
+    if(addr >= 0xc000)
+        return Location_Ram | (0xc000 + (addr & 0x1fff));
+
+    if(addr >= 0x8000 && (emu->mapperOptions & sms::SRAM_EnableSlot2))
+        return Location_Sram | addr;
+
+    if(!emu->rom || emu->romSize <= 0)
+        return Location_Rom | addr;
+
+    // First 1kb is always the first 1kb of rom, the rest goes through the bank of its slot
+    int offset = addr;
+
+    if(addr > 0x03ff) {
+        int slot = addr / (16*1024);
+        offset = (emu->mapperBankSelect[slot] * 16*1024 + addr - slot * 16*1024) % emu->romSize;
+    }
+    return Location_Rom | offset;
+}
+
+std::string Hotspots::name(uint32_t location) {
+    char text[16];
+    int offset = location & 0xffffff;
+
+    switch(location & 0xff000000) {
+        case Location_Rom:  std::snprintf(text, sizeof(text), "%02x:%04x", offset >> 14, offset & 0x3fff); break;
+        case Location_Ram:  std::snprintf(text, sizeof(text), "ram:%04x", offset); break;
+        case Location_Sram: std::snprintf(text, sizeof(text), "sram:%04x", offset); break;
+        default:            std::snprintf(text, sizeof(text), "root"); break;
+    }
+    return text;
+}
+
+void Hotspots::instruction(uint16_t start, const uint8_t* byte, int cycles) {
+    uint32_t location = locate(start);
+
+    // Starting somewhere else than the last instruction left off, an interrupt was taken in between
+    if(nextPC >= 0 && start != nextPC)
+        enter(location);
+
+    Spot& spot = spots[location];
+    spot.count ++;
+    spot.cycles += cycles;
+
+    nodes[stack.back()].cycles += cycles;
+    lastLocation = location;
+
+    uint16_t pc = emu->cpu.programCounter;
+    nextPC = pc;
+
+    uint8_t op = byte[0];
+
+    // Calls and restarts, conditional calls only once taken
+    if(op == 0xCD || (op & 0xC7) == 0xC7 || ((op & 0xC7) == 0xC4 && pc != (uint16_t)(start + 3))) {
+        enter(locate(pc));
+
+    // Returns, RETI and RETN included
+    }else if(op == 0xC9 || ((op & 0xC7) == 0xC0 && pc != (uint16_t)(start + 1)) || (op == 0xED && (byte[1] & 0xC7) == 0x45)) {
+
+        if(stack.size() > 1)
+            stack.pop_back();
+    }
+}
+
+void Hotspots::enter(uint32_t location) {
+
+    if(stack.size() >= maxDepth)
+        return;
+
+    uint64_t key = ((uint64_t)stack.back() << 32) | location;
+    auto found = children.find(key);
+
+    if(found == children.end()) {
+        found = children.emplace(key, nodes.size()).first;
+        nodes.push_back({ location, stack.back(), 0 });
+    }
+    stack.push_back(found->second);
+}
+
+void Hotspots::idle(int cycles) {
+    spots[lastLocation].cycles += cycles;
+    nodes[stack.back()].cycles += cycles;
+}
+
+void Hotspots::writeReport(std::ostream& out, size_t count) {
+    std::vector<std::pair<uint32_t, Spot>> sorted(spots.begin(), spots.end());
+    uint64_t total = 0;
+
+    for(auto& entry : sorted)
+        total += entry.second.cycles;
+
+    std::sort(sorted.begin(), sorted.end(), [](auto& a, auto& b) {
+        return a.second.cycles > b.second.cycles;
+    });
+
+    if(sorted.size() > count)
+        sorted.resize(count);
+
+    out << "location        count         cycles   share\n";
+
+    for(auto& entry : sorted) {
+        out << std::left << std::setw(9) << name(entry.first) << std::right;
+        out << std::setw(12) << entry.second.count << std::setw(15) << entry.second.cycles;
+        out << std::setw(7) << std::fixed << std::setprecision(2) << (total ? 100.0 * entry.second.cycles / total : 0) << "%\n";
+    }
+    out << "total cycles " << total << "\n";
+}
+
+void Hotspots::writeStacks(std::ostream& out) {
+
+    // Parents are always made before their children
+    std::vector<std::string> paths(nodes.size());
+
+    for(size_t i = 0; i < nodes.size(); i ++) {
+        const Node& node = nodes[i];
+        paths[i] = (node.parent < 0) ? name(node.location) : paths[node.parent] + ";" + name(node.location);
+
+        if(node.cycles > 0)
+            out << paths[i] << " " << node.cycles << "\n";
+    }
+}
\ No newline at end of file
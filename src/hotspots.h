@@ -0,0 +1,69 @@
+#ifndef HOTSPOT_PROFILER_H
+#define HOTSPOT_PROFILER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <iosfwd>
+
+struct sms;
+
+struct Hotspots {
+
+    Hotspots();
+    ~Hotspots();
+
+    // Start counting every instruction the machine runs, needs the cpu built with Z80_PROFILE
+    void attach(sms& emu);
+    void detach();
+
+    // Cycles skipped over by an idle loop, charged to the loop
+    void idle(int cycles);
+
+    // Addresses sorted by the cycles spent on them, limited to the top count
+    void writeReport(std::ostream& out, size_t count = 50);
+
+    // One line of semicolon separated calls and their cycles per call stack, as flame graph tools read them
+    void writeStacks(std::ostream& out);
+
+private:
+
+    /* Code is located by its rom bank and offset, so the same address in two banks stays apart */
+    enum LocationType {
+        Location_Rom    = 0x00000000,
+        Location_Ram    = 0x01000000,
+        Location_Sram   = 0x02000000,
+        Location_Root   = 0x03000000
+    };
+    uint32_t locate(uint16_t addr);
+    std::string name(uint32_t location);
+
+    struct Spot {
+        uint64_t count;
+        uint64_t cycles;
+    };
+    std::unordered_map<uint32_t, Spot> spots;
+
+    /* Call stacks as a tree, every node a call or interrupt entered from its parent */
+    struct Node {
+        uint32_t location;
+        int parent;
+        uint64_t cycles;
+    };
+    std::vector<Node> nodes;
+    std::unordered_map<uint64_t, int> children;
+    std::vector<int> stack;
+
+    // Deeper stacks are charged to the deepest node, programs dropping return addresses would grow it forever
+    static const size_t maxDepth = 256;
+
+    sms* emu;
+    uint32_t lastLocation;
+    int nextPC;
+
+    void instruction(uint16_t start, const uint8_t* byte, int cycles);
+    void enter(uint32_t location);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "lockstep.h"
+#include <stdexcept>
+
+// Controls that fit the input word, in the order of the sms enum
+static const int controlCount = sms::Joypad_B_Left + 1;
+
+// The console drives the TH lines itself, the rest are sent again after loading a state
+static const uint16_t resendControls = ((1 << controlCount) - 1) & ~(1 << sms::Joypad_A_TH) & ~(1 << sms::Joypad_B_TH);
+
+bool Lockstep::load(std::string romPath, int count) {
+    machines.clear();
+
+    for(int i = 0; i < count; i ++) {
+        std::unique_ptr<sms> emu = std::make_unique<sms>();
+        emu->debugConsole = NULL;
+
+        if(!emu->loadRom(romPath)) {
+            machines.clear();
+            return false;
+        }
+
+        // Instructions decoded by one machine are there for all of them
+        if(i > 0)
+            emu->shareDecode(*machines[0]);
+
+        machines.push_back(std::move(emu));
+    }
+
+    inputs.assign(count, 0);
+    applied.assign(count, 0);
+    running.assign(count, 1);
+    frames.assign(count, 0);
+    return true;
+}
+
+bool Lockstep::loadState(const uint8_t* data, size_t size) {
+
+    for(size_t i = 0; i < machines.size(); i ++) {
+
+        if(!machines[i]->loadState(data, size))
+            return false;
+
+        applied[i] = inputs[i] ^ resendControls;
+        running[i] = 1;
+        frames[i] = 0;
+    }
+    return true;
+}
+
+int Lockstep::getCount() {
+    return machines.size();
+}
+
+void Lockstep::setInput(int index, uint16_t pressed) {
+    inputs[index] = pressed;
+}
+
+uint16_t Lockstep::getInput(int index) {
+    return inputs[index];
+}
+
+void Lockstep::applyInputs(int index) {
+    uint16_t changed = inputs[index] ^ applied[index];
+
+    // Lines are pulled low while pressed
+    for(int control = 0; changed && control < controlCount; control ++) {
+
+        if(changed & (1 << control))
+            machines[index]->setJoyPadControl(control, !(inputs[index] & (1 << control)));
+    }
+    applied[index] = inputs[index];
+}
+
+int Lockstep::step(uint8_t output) {
+    int count = 0;
+
+    for(size_t i = 0; i < machines.size(); i ++) {
+
+        if(!running[i])
+            continue;
+
+        applyInputs(i);
+
+        try {
+            machines[i]->update(output);
+            frames[i] ++;
+            count ++;
+
+        }catch(std::exception& e) {
+            running[i] = 0;
+        }
+    }
+    return count;
+}
+
+bool Lockstep::isRunning(int index) {
+    return running[index];
+}
+
+uint32_t Lockstep::getFrame(int index) {
+    return frames[index];
+}
+
+const uint8_t* Lockstep::getRam(int index) {
+    return machines[index]->ram;
+}
+
+uint64_t Lockstep::getFrameHash(int index) {
+    return machines[index]->getFrameHash();
+}
+
+sms& Lockstep::getMachine(int index) {
+    return *machines[index];
+}
\ No newline at end of file
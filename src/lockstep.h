@@ -0,0 +1,56 @@
+#ifndef LOCKSTEP_RUNNER_H
+#define LOCKSTEP_RUNNER_H
+
+#include "sms.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+struct Lockstep {
+
+    // Load the rom into count machines sharing its mapping and decoded instructions, false when it can not be loaded
+    bool load(std::string romPath, int count);
+
+    // Start every machine from the same save state, the inputs set stay pressed
+    bool loadState(const uint8_t* data, size_t size);
+
+    int getCount();
+
+    /* Inputs of each machine, a bit per sms control held pressed until changed */
+
+    void setInput(int index, uint16_t pressed);
+    uint16_t getInput(int index);
+
+    // Emulate a frame on every machine still running, returns how many are
+    int step(uint8_t output = sms::Output_Video);
+
+    // Machines stop at an invalid opcode, the rest carry on
+    bool isRunning(int index);
+
+    // Frames emulated by a machine, short of the others once it stopped
+    uint32_t getFrame(int index);
+
+    /* Readback */
+
+    // System ram of a machine
+    const uint8_t* getRam(int index);
+
+    // Hash of the last frame of a machine
+    uint64_t getFrameHash(int index);
+
+    sms& getMachine(int index);
+
+private:
+
+    /* Runner state kept per field, the machines are whole and emulated one after another */
+    std::vector<std::unique_ptr<sms>> machines;
+    std::vector<uint16_t> inputs;
+    std::vector<uint16_t> applied;
+    std::vector<uint8_t> running;
+    std::vector<uint32_t> frames;
+
+    void applyInputs(int index);
+};
+
+#endif
\ No newline at end of file
@@ -1,15 +1,54 @@
 #include "sms.h"
+#include "wav.h"
+#include "rewind.h"
+#include "movie.h"
 #include <iostream>
 #include <chrono>
 #include <fstream>
 
 #include "SDL3/SDL.h"
 
+void draw(SDL_Renderer* renderer, SDL_Texture* frame, sms& emu) {
+    SDL_UpdateTexture(frame, NULL, emu.gpu.frameBuffer, sizeof(int) * 256);
+
+    SDL_FRect dst {
+        0.f, 
+        0.f, 
+        256.f, 
+        240.f, 
+    };
+
+    SDL_RenderTexture(renderer, frame, NULL, &dst);
+
+    SDL_RenderPresent(renderer);
+}
+
+void queueAudio(SDL_AudioStream* stream, sms& emu, int time) {
+
+    // Using time to determine format of the sample stream
+    if(time > 0) {
+        SDL_AudioSpec spec;
+        spec.channels = 2;
+        spec.format = SDL_AUDIO_S16;
+        spec.freq = 1000 * (emu.audioSamples.size() / 2) / time;
+        SDL_SetAudioStreamFormat(stream, &spec, NULL);
+        SDL_PutAudioStreamData(stream, emu.audioSamples.data(), emu.audioSamples.size() * sizeof(int16_t));
+        SDL_FlushAudioStream(stream);
+    }
+}
+
 int main(int argc, char* argv[]) {
 
     // Emulator options
     int         optionRomPath = 0;
     int         optionScreenScale = 3;
+    std::string optionWavPath;
+    bool        optionUncapped = false;
+    int         optionSpeed = 2;
+    bool        optionSpeedEnabled = false;
+    int         optionRunAhead = 0;
+    std::string optionRecordPath;
+    std::string optionPlayPath;
 
     for(int i = 1; i < argc; i ++) {
         std::string option = argv[i];
@@ -21,6 +60,30 @@ int main(int argc, char* argv[]) {
             i ++;
             if(i < argc) optionScreenScale = std::max(1, std::stoi(argv[i]));
 
+        }else if(option == "--wav") {
+            i ++;
+            if(i < argc) optionWavPath = argv[i];
+
+        }else if(option == "--uncapped") {
+            optionUncapped = true;
+
+        }else if(option == "--speed") {
+            i ++;
+            if(i < argc) optionSpeed = std::max(1, std::stoi(argv[i]));
+            optionSpeedEnabled = true;
+
+        }else if(option == "--runahead") {
+            i ++;
+            if(i < argc) optionRunAhead = std::max(0, std::stoi(argv[i]));
+
+        }else if(option == "--record") {
+            i ++;
+            if(i < argc) optionRecordPath = argv[i];
+
+        }else if(option == "--play") {
+            i ++;
+            if(i < argc) optionPlayPath = argv[i];
+
         }else {
             optionRomPath = i;
         }
@@ -50,6 +113,9 @@ int main(int argc, char* argv[]) {
     }
     SDL_SetRenderScale(renderer, optionScreenScale, optionScreenScale);
 
+    SDL_Texture* frame = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, 256, 240);
+    SDL_SetTextureScaleMode(frame, SDL_SCALEMODE_NEAREST);
+
     // Initialize the emulator
     sms emu;
 
@@ -58,83 +124,217 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    // Tee the audio into a wav file
+    WavWriter capture;
+
+    if(!optionWavPath.empty()) {
+
+        if(!capture.open(optionWavPath, 2, emu.getAudioFrequency())) {
+            std::cerr << "Error opening the wav file\n";
+            return 1;
+        }
+        emu.audioCapture = &capture;
+    }
+
+    // Movies replace the joypads, or record them from power on
+    Movie movie;
+
+    if(!optionPlayPath.empty()) {
+
+        if(!movie.play(optionPlayPath, emu)) {
+            std::cerr << "Error loading the movie\n";
+            return 1;
+        }
+        emu.movie = &movie;
+
+    }else if(!optionRecordPath.empty()) {
+
+        if(!movie.record(optionRecordPath, emu, false)) {
+            std::cerr << "Error opening the movie file\n";
+            return 1;
+        }
+        emu.movie = &movie;
+    }
+
+    // Battery saves live next to the rom, movies run without them to stay repeatable
+    if(!emu.movie && !emu.loadSram(std::string(argv[optionRomPath]) + ".sav"))
+        std::cerr << "Error opening the save file\n";
+
+    auto lastFlush = std::chrono::high_resolution_clock::now();
+
+    // Quick save slot next to the rom
+    std::string statePath = std::string(argv[optionRomPath]) + ".state";
+
+    // Recent history of the machine, stepped back while held
+    Rewind history;
+    bool rewinding = false;
+
+    // Real machine state while run ahead frames are shown
+    std::vector<uint8_t> runAheadState(emu.getStateSize());
+
     // Initialize the running loop
     bool run = true;
     std::clog.setstate(std::iostream::failbit);
 
-    while(run) {
-        auto start = std::chrono::high_resolution_clock::now();
+    auto lastPresent = std::chrono::high_resolution_clock::now();
+
+    int status = 0;
+
+    try {
 
-        // Read in SDL window inputs
-        SDL_Event event;
+        while(run) {
+            auto start = std::chrono::high_resolution_clock::now();
 
-        while(SDL_PollEvent(&event)) {
+            // Read in SDL window inputs
+            SDL_Event event;
 
-            if(event.type == SDL_EVENT_QUIT)
-                run = false;
+            while(SDL_PollEvent(&event)) {
+
+                if(event.type == SDL_EVENT_QUIT)
+                    run = false;
+
+                if(event.type == SDL_EVENT_KEY_DOWN) {
+
+                    switch(event.key.scancode) {
+                        case SDL_SCANCODE_UP:       emu.setJoyPadControl(sms::Joypad_A_Up, 0); break;
+                        case SDL_SCANCODE_DOWN:     emu.setJoyPadControl(sms::Joypad_A_Down, 0); break;
+                        case SDL_SCANCODE_LEFT:     emu.setJoyPadControl(sms::Joypad_A_Left, 0); break;
+                        case SDL_SCANCODE_RIGHT:    emu.setJoyPadControl(sms::Joypad_A_Right, 0); break;
+                        case SDL_SCANCODE_Z:        emu.setJoyPadControl(sms::Joypad_A_TL, 0); break;
+                        case SDL_SCANCODE_X:        emu.setJoyPadControl(sms::Joypad_A_TR, 0); break;
+                        case SDL_SCANCODE_SPACE:    std::cout << std::hex << (int)emu.cpu.programCounter << "\n"; break;
+                        case SDL_SCANCODE_RETURN:   emu.setJoyPadControl(sms::Console_Reset, 0); break;
+                        case SDL_SCANCODE_TAB:      optionUncapped = !optionUncapped; SDL_ClearAudioStream(stream); break;
+                        case SDL_SCANCODE_GRAVE:    optionSpeedEnabled = !optionSpeedEnabled; SDL_ClearAudioStream(stream); break;
+                        case SDL_SCANCODE_F5:       if(!emu.saveStateFile(statePath)) std::cerr << "Error saving the state\n"; break;
+                        case SDL_SCANCODE_F7:       if(emu.movie || !emu.loadStateFile(statePath)) std::cerr << "Error loading the state\n"; else history.clear(); break;
+                        case SDL_SCANCODE_BACKSPACE:if(!event.key.repeat && !emu.movie) rewinding = true; SDL_ClearAudioStream(stream); break;
+                    }
+                }
 
-            if(event.type == SDL_EVENT_KEY_DOWN) {
+                if(event.type == SDL_EVENT_KEY_UP) {
 
-                switch(event.key.scancode) {
-                    case SDL_SCANCODE_UP:       emu.setJoyPadControl(sms::Joypad_A_Up, 0); break;
-                    case SDL_SCANCODE_DOWN:     emu.setJoyPadControl(sms::Joypad_A_Down, 0); break;
-                    case SDL_SCANCODE_LEFT:     emu.setJoyPadControl(sms::Joypad_A_Left, 0); break;
-                    case SDL_SCANCODE_RIGHT:    emu.setJoyPadControl(sms::Joypad_A_Right, 0); break;
-                    case SDL_SCANCODE_Z:        emu.setJoyPadControl(sms::Joypad_A_TL, 0); break;
-                    case SDL_SCANCODE_X:        emu.setJoyPadControl(sms::Joypad_A_TR, 0); break;
-                    case SDL_SCANCODE_SPACE:    std::cout << std::hex << (int)emu.cpu.programCounter << "\n"; break;
-                    case SDL_SCANCODE_RETURN:   emu.setJoyPadControl(sms::Console_Reset, 0); break;
+                    switch(event.key.scancode) {
+                        case SDL_SCANCODE_UP:       emu.setJoyPadControl(sms::Joypad_A_Up, 1); break;
+                        case SDL_SCANCODE_DOWN:     emu.setJoyPadControl(sms::Joypad_A_Down, 1); break;
+                        case SDL_SCANCODE_LEFT:     emu.setJoyPadControl(sms::Joypad_A_Left, 1); break;
+                        case SDL_SCANCODE_RIGHT:    emu.setJoyPadControl(sms::Joypad_A_Right, 1); break;
+                        case SDL_SCANCODE_Z:        emu.setJoyPadControl(sms::Joypad_A_TL, 1); break;
+                        case SDL_SCANCODE_X:        emu.setJoyPadControl(sms::Joypad_A_TR, 1); break;
+                        case SDL_SCANCODE_RETURN:   emu.setJoyPadControl(sms::Console_Reset, 1); break;
+                        case SDL_SCANCODE_BACKSPACE:rewinding = false; break;
+                    }
                 }
             }
 
-            if(event.type == SDL_EVENT_KEY_UP) {
+            // Resize the window based on the current device emulated
+            int w, h;
+            if(SDL_GetWindowSize(window, &w, &h)) {
+                w /= optionScreenScale;
+                h /= optionScreenScale;
 
-                switch(event.key.scancode) {
-                    case SDL_SCANCODE_UP:       emu.setJoyPadControl(sms::Joypad_A_Up, 1); break;
-                    case SDL_SCANCODE_DOWN:     emu.setJoyPadControl(sms::Joypad_A_Down, 1); break;
-                    case SDL_SCANCODE_LEFT:     emu.setJoyPadControl(sms::Joypad_A_Left, 1); break;
-                    case SDL_SCANCODE_RIGHT:    emu.setJoyPadControl(sms::Joypad_A_Right, 1); break;
-                    case SDL_SCANCODE_Z:        emu.setJoyPadControl(sms::Joypad_A_TL, 1); break;
-                    case SDL_SCANCODE_X:        emu.setJoyPadControl(sms::Joypad_A_TR, 1); break;
-                    case SDL_SCANCODE_RETURN:   emu.setJoyPadControl(sms::Console_Reset, 1); break;
+                if(w != emu.gpu.getScreenWidth() || h != emu.gpu.getScreenHeight()) {
+                    SDL_SetWindowSize(window, emu.gpu.getScreenWidth() * optionScreenScale, emu.gpu.getScreenHeight() * optionScreenScale);
+                    SDL_Rect viewport {
+                        -emu.gpu.getScreenOffsetX(),
+                        -emu.gpu.getScreenOffsetY(),
+                        emu.gpu.getScreenWidth() + emu.gpu.getScreenOffsetX(),
+                        emu.gpu.getScreenHeight() + emu.gpu.getScreenOffsetY()
+                    };
+                    SDL_SetRenderViewport(renderer, &viewport);
                 }
             }
-        }
 
-        // Resize the window based on the current device emulated
-        int w, h;
-        if(SDL_GetWindowSize(window, &w, &h)) {
-            w /= optionScreenScale;
-            h /= optionScreenScale;
-
-            if(w != emu.gpu.getScreenWidth() || h != emu.gpu.getScreenHeight()) {
-                SDL_SetWindowSize(window, emu.gpu.getScreenWidth() * optionScreenScale, emu.gpu.getScreenHeight() * optionScreenScale);
-                SDL_Rect viewport {
-                    -emu.gpu.getScreenOffsetX(),
-                    -emu.gpu.getScreenOffsetY(),
-                    emu.gpu.getScreenWidth() + emu.gpu.getScreenOffsetX(),
-                    emu.gpu.getScreenHeight() + emu.gpu.getScreenOffsetY()
-                };
-                SDL_SetRenderViewport(renderer, &viewport);
+            // Fast forward emulates several frames per loop, only the last one is shown
+            int frames = (optionSpeedEnabled) ? optionSpeed : 1;
+            bool fastForward = optionUncapped || frames > 1 || rewinding;
+
+            // Emulate the frames and sync with the time a real system would take
+            int time = 0;
+
+            bool runAhead = optionRunAhead > 0 && !rewinding;
+
+            for(int i = 0; i < frames; i ++) {
+
+                // Rewinding replays the previous frame to regenerate its picture, stopping once out of history
+                if(rewinding && !history.rewind(emu))
+                    rewinding = false;
+
+                // The picture of the last real frame is replaced by the run ahead one
+                if(runAhead && i == frames - 1)
+                    time += emu.update(sms::Output_Audio);
+                else
+                    time += emu.update();
+
+                history.capture(emu);
+            }
+
+            // Audio is dropped while fast forwarding
+            if(!fastForward)
+                queueAudio(stream, emu, time);
+
+            // Speculate with the current inputs and only draw the last frame, then return to the real state
+            if(runAhead) {
+                emu.saveState(runAheadState.data());
+                emu.movie = NULL;
+
+                for(int i = 0; i < optionRunAhead; i ++)
+                    emu.update((i == optionRunAhead - 1) ? sms::Output_Video : 0);
+
+                emu.loadState(runAheadState.data(), runAheadState.size());
+
+                if(movie.isPlaying() || movie.isRecording())
+                    emu.movie = &movie;
+            }
+
+            auto end = std::chrono::high_resolution_clock::now();
+
+            // Uncapped frames are shown at most once per real frame time
+            if(!optionUncapped || end - lastPresent >= std::chrono::milliseconds(time)) {
+                draw(renderer, frame, emu);
+                lastPresent = end;
+            }
+
+            // Write back the battery save in the background every second
+            if(end - lastFlush >= std::chrono::seconds(1)) {
+                emu.flushSram();
+                lastFlush = end;
+            }
+
+            end = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+            time /= frames;
+
+            if(!optionUncapped && duration.count() < time) {
+                int diff = time - duration.count();
+                SDL_Delay(diff);
             }
         }
 
-        // Emulate a frame and sync with the time a real system would take
-        int time = emu.update(renderer, stream);
+    }catch(std::exception& e) {
+        std::cerr << e.what() << "\n";
+        status = 1;
 
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        if(emu.invalidOpcodeAddress >= 0) {
+            std::cerr << std::hex << emu.invalidOpcodeAddress << ":";
 
-        if(duration.count() < time) {
-            int diff = time - duration.count();
-            SDL_Delay(diff);
+            for(int i = 0; i < 4; i ++)
+                std::cerr << " " << (int)emu.invalidOpcode[i];
+
+            std::cerr << std::dec << "\n";
         }
     }
 
+    SDL_DestroyTexture(frame);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
 
+#ifdef Z80_PROFILE
+    emu.cpu.writeProfile(std::cerr);
+#endif
+
     std::clog << "Complete";
 
-    return 0;
+    return status;
 }
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include "movie.h"
+#include "sms.h"
+#include <cstring>
+#include <climits>
+
+static const char movieMagic[4] = { 'S', 'M', 'S', 'M' };
+static const uint32_t movieVersion = 1;
+
+enum MovieStart {
+    START_POWER_ON, START_STATE
+};
+
+// Offset of the frame count patched on close
+static const size_t frameCountOffset = 16;
+
+template<typename T>
+static void writeField(std::fstream& file, T value) {
+    file.write((const char*)&value, sizeof(value));
+}
+
+template<typename T>
+static bool readField(std::fstream& file, T& value) {
+    file.read((char*)&value, sizeof(value));
+    return file.good();
+}
+
+Movie::Movie() {
+    mode = NONE;
+    position = 0;
+    replaying = false;
+    frame = 0;
+    frameCount = 0;
+}
+
+Movie::~Movie() {
+    close();
+}
+
+bool Movie::record(std::string path, sms& emu, bool fromState) {
+    close();
+
+    file.open(path, std::fstream::binary | std::fstream::out | std::fstream::trunc);
+
+    if(!file.good()) {
+        file.close();
+        return false;
+    }
+
+    // Header of magic, version, rom hash, frame count and the starting point
+    file.write(movieMagic, sizeof(movieMagic));
+    writeField<uint32_t>(file, movieVersion);
+    writeField<uint64_t>(file, emu.getRomHash());
+    writeField<uint32_t>(file, 0);
+
+    if(fromState) {
+        std::vector<uint8_t> state(emu.getStateSize());
+        emu.saveState(state.data());
+
+        writeField<uint8_t>(file, START_STATE);
+        writeField<uint32_t>(file, state.size());
+        file.write((char*)state.data(), state.size());
+
+    }else {
+        writeField<uint8_t>(file, START_POWER_ON);
+        writeField<uint32_t>(file, 0);
+    }
+
+    if(!file.good()) {
+        file.close();
+        return false;
+    }
+    mode = RECORDING;
+    frame = 0;
+    frameCount = 0;
+    return true;
+}
+
+bool Movie::play(std::string path, sms& emu) {
+    close();
+
+    file.open(path, std::fstream::binary | std::fstream::in);
+
+    if(!file.good()) {
+        file.close();
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version;
+    uint64_t romHash;
+    uint8_t start;
+    uint32_t stateSize;
+
+    file.read(magic, sizeof(magic));
+
+    bool valid =
+        file.good() && std::memcmp(magic, movieMagic, sizeof(magic)) == 0 &&
+        readField(file, version) && version == movieVersion &&
+        readField(file, romHash) && romHash == emu.getRomHash() &&
+        readField(file, frameCount) &&
+        readField(file, start) &&
+        readField(file, stateSize);
+
+    // Movies starting from a state carry it, power on movies expect a freshly loaded rom
+    if(valid && start == START_STATE) {
+        std::vector<uint8_t> state(stateSize);
+        file.read((char*)state.data(), state.size());
+
+        valid = file.good() && emu.loadState(state.data(), state.size());
+    }
+
+    if(!valid) {
+        file.close();
+        return false;
+    }
+
+    // Inputs run until the end of the file
+    events.clear();
+    Event event;
+
+    while(readField(file, event.frame) && readField(file, event.clock) && readField(file, event.control) && readField(file, event.value))
+        events.push_back(event);
+
+    file.close();
+
+    // Recordings cut short never had their frame count written
+    if(frameCount == 0 && !events.empty())
+        frameCount = events.back().frame + 1;
+
+    mode = PLAYING;
+    position = 0;
+    frame = 0;
+    return true;
+}
+
+void Movie::close() {
+
+    if(mode == RECORDING) {
+        file.seekp(frameCountOffset);
+        writeField<uint32_t>(file, frameCount);
+        file.close();
+    }
+    events.clear();
+    mode = NONE;
+}
+
+bool Movie::isRecording() {
+    return mode == RECORDING;
+}
+
+bool Movie::isPlaying() {
+    return mode == PLAYING;
+}
+
+uint32_t Movie::getFrameCount() {
+    return frameCount;
+}
+
+bool Movie::input(uint8_t control, bool val, int clock) {
+
+    if(mode == PLAYING)
+        return replaying;
+
+    if(mode == RECORDING) {
+        writeField<uint32_t>(file, frame);
+        writeField<uint32_t>(file, clock);
+        writeField<uint8_t>(file, control);
+        writeField<uint8_t>(file, val);
+    }
+    return true;
+}
+
+int Movie::replay(sms& emu, int clock) {
+
+    if(mode != PLAYING)
+        return INT_MAX;
+
+    while(position < events.size() && events[position].frame <= frame) {
+        Event& event = events[position];
+
+        if(event.frame == frame && (int)event.clock > clock)
+            return event.clock;
+
+        replaying = true;
+        emu.setJoyPadControl(event.control, event.value);
+        replaying = false;
+
+        position ++;
+    }
+    return INT_MAX;
+}
+
+void Movie::endFrame() {
+    frame ++;
+
+    if(mode == RECORDING)
+        frameCount = frame;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef MOVIE_FILE_H
+#define MOVIE_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+
+struct sms;
+
+struct Movie {
+
+    Movie();
+    ~Movie();
+
+    // Start recording joypad changes, either from the current state or as a power on run of a freshly loaded rom
+    bool record(std::string path, sms& emu, bool fromState);
+
+    // Load a movie and bring the machine to its start, fails when it was made for another rom
+    bool play(std::string path, sms& emu);
+
+    void close();
+
+    bool isRecording();
+    bool isPlaying();
+
+    // Frames recorded so far, or the length of the movie being played
+    uint32_t getFrameCount();
+
+    /* Called by the emulator */
+
+    // Every joypad change passes through here, false when a playing movie is in control of the inputs
+    bool input(uint8_t control, bool val, int clock);
+
+    // Apply the inputs due by clock in the current frame, returns the clock of the next one or INT_MAX
+    int replay(sms& emu, int clock);
+    void endFrame();
+
+private:
+
+    /* Inputs are stamped with the frame and the cpu cycles into that frame */
+    struct Event {
+        uint32_t frame;
+        uint32_t clock;
+        uint8_t control;
+        uint8_t value;
+    };
+
+    enum Mode {
+        NONE, RECORDING, PLAYING
+    };
+    uint8_t mode;
+
+    std::fstream file;
+    std::vector<Event> events;
+    size_t position;
+    bool replaying;
+    uint32_t frame;
+    uint32_t frameCount;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "lockstep.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+
+// Direction and buttons of the first joypad, the controls random play presses
+static const uint16_t playControls =
+    (1 << sms::Joypad_A_Up) | (1 << sms::Joypad_A_Down) | (1 << sms::Joypad_A_Left) |
+    (1 << sms::Joypad_A_Right) | (1 << sms::Joypad_A_TL) | (1 << sms::Joypad_A_TR);
+
+// Controls an instance holds during a frame, a new choice every 8 frames from its own seed
+static uint16_t randomInput(uint64_t seed, int instance, int frame) {
+    uint64_t x = seed * 0x9E3779B97F4A7C15ull + (uint64_t)instance * 0xBF58476D1CE4E5B9ull + (uint64_t)(frame / 8) * 0x94D049BB133111EBull;
+
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+
+    return x & playControls;
+}
+
+static uint64_t hashRam(const uint8_t* ram) {
+    uint64_t hash = 14695981039346656037ull;
+
+    for(size_t i = 0; i < sizeof(sms::ram); i ++) {
+        hash ^= ram[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Plays an instance again on a machine of its own, true when it ends up the same as in lockstep
+static bool checkInstance(std::string romPath, uint64_t seed, Lockstep& lockstep, int index) {
+    std::unique_ptr<sms> emu = std::make_unique<sms>();
+    emu->debugConsole = NULL;
+
+    if(!emu->loadRom(romPath))
+        return false;
+
+    // A stopped instance threw partway through the frame after its last one
+    int frames = lockstep.getFrame(index) + (lockstep.isRunning(index) ? 0 : 1);
+    bool stopped = false;
+    uint16_t applied = 0;
+
+    try {
+
+        for(int frame = 0; frame < frames; frame ++) {
+            uint16_t pressed = randomInput(seed, index, frame);
+            uint16_t changed = pressed ^ applied;
+
+            for(int control = 0; control < 16; control ++) {
+
+                if(changed & (1 << control))
+                    emu->setJoyPadControl(control, !(pressed & (1 << control)));
+            }
+            applied = pressed;
+
+            emu->update();
+        }
+
+    }catch(std::exception& e) {
+        stopped = true;
+    }
+
+    return stopped == !lockstep.isRunning(index) &&
+        std::memcmp(emu->ram, lockstep.getRam(index), sizeof(emu->ram)) == 0 &&
+        emu->getFrameHash() == lockstep.getFrameHash(index);
+}
+
+int main(int argc, char* argv[]) {
+
+    // Play test options
+    int         optionRomPath = 0;
+    int         optionFrames = 600;
+    int         optionInstances = 64;
+    uint64_t    optionSeed = 1;
+    bool        optionCheck = false;
+    std::string optionOutputPath;
+
+    for(int i = 1; i < argc; i ++) {
+        std::string option = argv[i];
+
+        if(option == "--help") {
+            std::cout << "sms-playtest [options] program\n";
+            std::cout << "\t--frames <count>\tNumber of frames to emulate\n";
+            std::cout << "\t--instances <count>\tNumber of machines run in lockstep, 64 by default\n";
+            std::cout << "\t--seed <number>\t\tStarts the random inputs of every machine from another seed\n";
+            std::cout << "\t--check\t\t\tPlays every machine again on its own and compares the results\n";
+            std::cout << "\t--output <file>\t\tWrites the results to a csv file instead of stdout\n";
+            return 0;
+
+        }else if(option == "--frames" || option == "-n") {
+            i ++;
+            if(i < argc) optionFrames = std::max(0, std::stoi(argv[i]));
+
+        }else if(option == "--instances") {
+            i ++;
+            if(i < argc) optionInstances = std::max(1, std::stoi(argv[i]));
+
+        }else if(option == "--seed") {
+            i ++;
+            if(i < argc) optionSeed = std::stoull(argv[i]);
+
+        }else if(option == "--check") {
+            optionCheck = true;
+
+        }else if(option == "--output") {
+            i ++;
+            if(i < argc) optionOutputPath = argv[i];
+
+        }else {
+            optionRomPath = i;
+        }
+    }
+
+    if(optionRomPath == 0) {
+        std::cerr << "No rom given\n";
+        return 1;
+    }
+
+    Lockstep lockstep;
+
+    if(!lockstep.load(argv[optionRomPath], optionInstances)) {
+        std::cerr << "Error loading the rom\n";
+        return 1;
+    }
+
+    // Every machine gets its own inputs before each frame
+    auto start = std::chrono::steady_clock::now();
+
+    for(int frame = 0; frame < optionFrames; frame ++) {
+
+        for(int i = 0; i < optionInstances; i ++)
+            lockstep.setInput(i, randomInput(optionSeed, i, frame));
+
+        if(lockstep.step() == 0)
+            break;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    std::fstream file;
+
+    if(!optionOutputPath.empty()) {
+        file.open(optionOutputPath, std::fstream::out | std::fstream::trunc);
+
+        if(!file.good()) {
+            std::cerr << "Error opening the output file\n";
+            return 1;
+        }
+    }
+    std::ostream& out = (file.is_open()) ? file : std::cout;
+
+    out << "instance,status,frames,ram_hash,frame_hash\n";
+
+    uint64_t frames = 0;
+
+    for(int i = 0; i < optionInstances; i ++) {
+        out << std::dec << i << "," << (lockstep.isRunning(i) ? "ok" : "invalid-opcode") << "," << lockstep.getFrame(i) << ",";
+        out << std::hex << hashRam(lockstep.getRam(i)) << "," << lockstep.getFrameHash(i) << std::dec << "\n";
+
+        frames += lockstep.getFrame(i);
+    }
+
+    std::cerr << optionInstances << " instances, " << frames << " frames, " << seconds << " seconds, ";
+    std::cerr << (seconds > 0 ? frames / seconds : 0) << " frames per second\n";
+
+    if(!optionCheck)
+        return 0;
+
+    // The same inputs on separate machines have to give the same ram and frames
+    int mismatches = 0;
+
+    start = std::chrono::steady_clock::now();
+
+    for(int i = 0; i < optionInstances; i ++) {
+
+        if(!checkInstance(argv[optionRomPath], optionSeed, lockstep, i)) {
+            std::cerr << "Instance " << i << " differs from a machine run on its own\n";
+            mismatches ++;
+        }
+    }
+
+    end = std::chrono::steady_clock::now();
+
+    std::cerr << mismatches << " instances differ, separate machines took " << std::chrono::duration<double>(end - start).count() << " seconds\n";
+
+    return (mismatches > 0) ? 1 : 0;
+}
\ No newline at end of file
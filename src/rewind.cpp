@@ -0,0 +1,200 @@
+#include "rewind.h"
+#include "sms.h"
+#include <cstring>
+
+static uint8_t* writeVarint(uint8_t* out, size_t value) {
+
+    while(value >= 0x80) {
+        *out++ = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    *out++ = value;
+    return out;
+}
+
+static const uint8_t* readVarint(const uint8_t* in, size_t& value) {
+    value = 0;
+
+    for(int shift = 0; ; shift += 7) {
+        value |= (size_t)(*in & 0x7F) << shift;
+
+        if((*in++ & 0x80) == 0)
+            break;
+    }
+    return in;
+}
+
+Rewind::Rewind(size_t capacity, int keyframeInterval) {
+    ring.resize(capacity);
+    this->keyframeInterval = keyframeInterval;
+    clear();
+}
+
+void Rewind::clear() {
+    head = 0;
+    entries.clear();
+    frameNumber = 0;
+    keyframeFrame = 0;
+    keyframeValid = false;
+}
+
+size_t Rewind::getFrameCount() {
+    return entries.size();
+}
+
+size_t Rewind::encode(const uint8_t* data, const uint8_t* reference, uint8_t* out) {
+    uint8_t* start = out;
+    size_t size = state.size();
+    size_t i = 0;
+
+    // Pairs of unchanged byte runs and literal XOR runs
+    while(i < size) {
+        size_t zeros = i;
+
+        while(zeros < size && (data[zeros] ^ (reference ? reference[zeros] : 0)) == 0)
+            zeros ++;
+
+        // Literals end on a run of 4 unchanged bytes
+        size_t literals = zeros;
+        size_t unchanged = 0;
+
+        while(literals < size && unchanged < 4) {
+            unchanged = ((data[literals] ^ (reference ? reference[literals] : 0)) == 0) ? unchanged + 1 : 0;
+            literals ++;
+        }
+        literals -= unchanged;
+
+        out = writeVarint(out, zeros - i);
+        out = writeVarint(out, literals - zeros);
+
+        for(size_t n = zeros; n < literals; n ++)
+            *out++ = data[n] ^ (reference ? reference[n] : 0);
+
+        i = literals;
+    }
+    return out - start;
+}
+
+void Rewind::decode(const uint8_t* in, size_t size, uint8_t* out) {
+    const uint8_t* end = in + size;
+    size_t i = 0;
+
+    while(in < end) {
+        size_t zeros, literals;
+        in = readVarint(in, zeros);
+        in = readVarint(in, literals);
+
+        i += zeros;
+
+        for(size_t n = 0; n < literals; n ++)
+            out[i++] ^= *in++;
+    }
+}
+
+void Rewind::evict(size_t offset, size_t size, bool wrapped) {
+
+    // Wrapping skips the tail of the ring, which holds the oldest snapshots
+    while(!entries.empty() && wrapped && entries.front().offset >= head)
+        entries.pop_front();
+
+    while(!entries.empty() && entries.front().offset < offset + size && offset < entries.front().offset + entries.front().size)
+        entries.pop_front();
+
+    // Deltas are useless without their keyframe
+    while(!entries.empty() && entries.front().keyframe != entries.front().frame)
+        entries.pop_front();
+}
+
+void Rewind::capture(sms& emu) {
+
+    if(state.empty()) {
+        state.resize(emu.getStateSize());
+        keyframeState.resize(state.size());
+    }
+    emu.saveState(state.data());
+
+    // Worst case encoding of every byte changing
+    size_t maxSize = state.size() * 2 + 32;
+
+    if(maxSize > ring.size())
+        return;
+
+    bool keyframe = !keyframeValid || entries.empty() || frameNumber - keyframeFrame >= (uint64_t)keyframeInterval;
+    bool wrapped = head + maxSize > ring.size();
+
+    if(wrapped)
+        evict(0, maxSize, true);
+    else
+        evict(head, maxSize, false);
+
+    size_t offset = (wrapped) ? 0 : head;
+
+    // Losing the keyframe forces a new one
+    if(!keyframe && (entries.empty() || entries.back().keyframe != keyframeFrame))
+        keyframe = true;
+
+    Entry entry;
+    entry.offset = offset;
+    entry.frame = frameNumber;
+
+    if(keyframe) {
+        entry.size = encode(state.data(), NULL, &ring[offset]);
+        entry.keyframe = frameNumber;
+
+        std::memcpy(keyframeState.data(), state.data(), state.size());
+        keyframeFrame = frameNumber;
+        keyframeValid = true;
+
+    }else {
+        entry.size = encode(state.data(), keyframeState.data(), &ring[offset]);
+        entry.keyframe = keyframeFrame;
+    }
+
+    entries.push_back(entry);
+    head = offset + entry.size;
+    frameNumber ++;
+}
+
+bool Rewind::restore(sms& emu) {
+    Entry& entry = entries.back();
+
+    // Decode the keyframe this snapshot is relative to
+    if(!keyframeValid || keyframeFrame != entry.keyframe) {
+
+        for(auto it = entries.rbegin(); it != entries.rend(); it ++) {
+
+            if(it->frame == entry.keyframe) {
+                std::memset(keyframeState.data(), 0, keyframeState.size());
+                decode(&ring[it->offset], it->size, keyframeState.data());
+                keyframeFrame = it->frame;
+                keyframeValid = true;
+                break;
+            }
+        }
+
+        if(!keyframeValid || keyframeFrame != entry.keyframe)
+            return false;
+    }
+
+    std::memcpy(state.data(), keyframeState.data(), state.size());
+
+    if(entry.frame != entry.keyframe)
+        decode(&ring[entry.offset], entry.size, state.data());
+
+    return emu.loadState(state.data(), state.size());
+}
+
+bool Rewind::rewind(sms& emu) {
+
+    // Drop the current and previous frame, then replaying from the one before
+    if(entries.size() < 3)
+        return false;
+
+    entries.pop_back();
+    entries.pop_back();
+
+    head = entries.back().offset + entries.back().size;
+    frameNumber = entries.back().frame + 1;
+
+    return restore(emu);
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef REWIND_BUFFER_H
+#define REWIND_BUFFER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <deque>
+
+struct sms;
+
+struct Rewind {
+
+    Rewind(size_t capacity = 64 * 1024 * 1024, int keyframeInterval = 60);
+
+    // Snapshot the machine, called once per emulated frame
+    void capture(sms& emu);
+
+    // Step back so the next update() replays the previous frame, false when out of history
+    bool rewind(sms& emu);
+
+    void clear();
+    size_t getFrameCount();
+
+private:
+
+    /* Snapshots are XOR deltas against their keyframe, run length encoded into a byte ring */
+    struct Entry {
+        size_t offset;
+        size_t size;
+        uint64_t frame;
+        uint64_t keyframe;
+    };
+    std::vector<uint8_t> ring;
+    size_t head;
+    std::deque<Entry> entries;
+
+    uint64_t frameNumber;
+    int keyframeInterval;
+
+    std::vector<uint8_t> state;
+    std::vector<uint8_t> keyframeState;
+    uint64_t keyframeFrame;
+    bool keyframeValid;
+
+    size_t encode(const uint8_t* data, const uint8_t* reference, uint8_t* out);
+    void decode(const uint8_t* in, size_t size, uint8_t* out);
+    void evict(size_t offset, size_t size, bool wrapped);
+    bool restore(sms& emu);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include "sms.h"
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+/* Every field is visited in the same order to save, load and size a state */
+
+struct StateWriter {
+    uint8_t* ptr;
+
+    void field(const void* data, size_t size) {
+        std::memcpy(ptr, data, size);
+        ptr += size;
+    }
+
+    void pages(const void* data, size_t size, size_t, uint32_t&) {
+        field(data, size);
+    }
+};
+
+struct StateReader {
+    const uint8_t* ptr;
+
+    void field(void* data, size_t size) {
+        std::memcpy(data, ptr, size);
+        ptr += size;
+    }
+
+    // Pages already holding the same bytes are left alone, the ones written are marked
+    void pages(void* data, size_t size, size_t pageSize, uint32_t& dirty) {
+
+        for(size_t offset = 0; offset < size; offset += pageSize) {
+            size_t length = std::min(pageSize, size - offset);
+
+            if(std::memcmp((uint8_t*)data + offset, ptr + offset, length) != 0) {
+                std::memcpy((uint8_t*)data + offset, ptr + offset, length);
+                dirty |= 1 << (offset / pageSize);
+            }
+        }
+        ptr += size;
+    }
+};
+
+struct StateCounter {
+    size_t size = 0;
+
+    void field(const void*, size_t size) {
+        this->size += size;
+    }
+
+    void pages(const void*, size_t size, size_t, uint32_t&) {
+        this->size += size;
+    }
+};
+
+template<typename Visitor>
+static void visitState(sms& emu, Visitor& v) {
+
+    // Z80, registers stay in A, F, B, C order whatever the byte order of the host
+    static const int registerOrder[16] {
+        Z80::A, Z80::F, Z80::B, Z80::C, Z80::D, Z80::E, Z80::H, Z80::L,
+        Z80::A_p, Z80::F_p, Z80::B_p, Z80::C_p, Z80::D_p, Z80::E_p, Z80::H_p, Z80::L_p
+    };
+
+    for(int r : registerOrder)
+        v.field(&emu.cpu.reg[r], sizeof(emu.cpu.reg[r]));
+
+    v.field(&emu.cpu.interruptVector, sizeof(emu.cpu.interruptVector));
+    v.field(&emu.cpu.memoryRefresh, sizeof(emu.cpu.memoryRefresh));
+    v.field(&emu.cpu.indexRegisterX, sizeof(emu.cpu.indexRegisterX));
+    v.field(&emu.cpu.indexRegisterY, sizeof(emu.cpu.indexRegisterY));
+    v.field(&emu.cpu.stackPointer, sizeof(emu.cpu.stackPointer));
+    v.field(&emu.cpu.programCounter, sizeof(emu.cpu.programCounter));
+    v.field(&emu.cpu.interruptMode, sizeof(emu.cpu.interruptMode));
+    v.field(&emu.cpu.IFF1, sizeof(emu.cpu.IFF1));
+    v.field(&emu.cpu.IFF2, sizeof(emu.cpu.IFF2));
+    v.field(&emu.cpu.haltState, sizeof(emu.cpu.haltState));
+    v.field(&emu.cpu.eiState, sizeof(emu.cpu.eiState));
+
+    // TMS9918A
+    v.field(emu.gpu.reg, sizeof(emu.gpu.reg));
+    v.field(&emu.gpu.mode, sizeof(emu.gpu.mode));
+    v.field(emu.gpu.vram, sizeof(emu.gpu.vram));
+    v.field(emu.gpu.cram, sizeof(emu.gpu.cram));
+    v.field(&emu.gpu.status, sizeof(emu.gpu.status));
+    v.field(&emu.gpu.videoFormat, sizeof(emu.gpu.videoFormat));
+    v.field(&emu.gpu.requestLineInterrupt, sizeof(emu.gpu.requestLineInterrupt));
+    v.field(&emu.gpu.requestFrameInterrupt, sizeof(emu.gpu.requestFrameInterrupt));
+    v.field(&emu.gpu.controlOffset, sizeof(emu.gpu.controlOffset));
+    v.field(&emu.gpu.controlWord, sizeof(emu.gpu.controlWord));
+    v.field(&emu.gpu.readBuffer, sizeof(emu.gpu.readBuffer));
+    v.field(&emu.gpu.vCounter, sizeof(emu.gpu.vCounter));
+    v.field(&emu.gpu.hCounter, sizeof(emu.gpu.hCounter));
+    v.field(&emu.gpu.lineCounter, sizeof(emu.gpu.lineCounter));
+    v.field(&emu.gpu.hCounterBuffer, sizeof(emu.gpu.hCounterBuffer));
+
+    // SN76489
+    v.field(emu.psg.reg, sizeof(emu.psg.reg));
+    v.field(emu.psg.counter, sizeof(emu.psg.counter));
+    v.field(emu.psg.output, sizeof(emu.psg.output));
+    v.field(&emu.psg.linearFeedback, sizeof(emu.psg.linearFeedback));
+    v.field(&emu.psg.outputNoise, sizeof(emu.psg.outputNoise));
+    v.field(&emu.psg.latchChannel, sizeof(emu.psg.latchChannel));
+    v.field(&emu.psg.latchType, sizeof(emu.psg.latchType));
+    v.field(&emu.psg.stereo, sizeof(emu.psg.stereo));
+
+    // Memory, mapper and inputs, save ram can be the save file itself so loads only write the pages that differ
+    v.field(emu.ram, sizeof(emu.ram));
+    v.pages(emu.sram, sizeof(emu.sramBuffer), emu.sramPageSize, emu.sramDirty);
+    v.field(&emu.mapperOptions, sizeof(emu.mapperOptions));
+    v.field(emu.mapperBankSelect, sizeof(emu.mapperBankSelect));
+    v.field(&emu.joypad1, sizeof(emu.joypad1));
+    v.field(&emu.joypad2, sizeof(emu.joypad2));
+    v.field(&emu.joypadStart, sizeof(emu.joypadStart));
+
+    // Cycles into the frame, the clock of movie inputs and interrupt deadlines
+    v.field(&emu.frameClock, sizeof(emu.frameClock));
+}
+
+static const char stateMagic[4] = { 'S', 'M', 'S', 'S' };
+static const size_t stateHeaderSize = 12;
+
+size_t sms::getStateSize() {
+    StateCounter counter;
+    visitState(*this, counter);
+    return stateHeaderSize + counter.size;
+}
+
+void sms::saveState(uint8_t* data) {
+    uint32_t version = StateVersion;
+    uint32_t size = getStateSize();
+
+    // Header of magic, version and total size
+    StateWriter writer { data };
+    writer.field(stateMagic, sizeof(stateMagic));
+    writer.field(&version, sizeof(version));
+    writer.field(&size, sizeof(size));
+
+    visitState(*this, writer);
+}
+
+bool sms::loadState(const uint8_t* data, size_t size) {
+
+    if(size != getStateSize())
+        return false;
+
+    uint32_t version;
+    uint32_t stateSize;
+
+    StateReader reader { data + sizeof(stateMagic) };
+    reader.field(&version, sizeof(version));
+    reader.field(&stateSize, sizeof(stateSize));
+
+    if(std::memcmp(data, stateMagic, sizeof(stateMagic)) != 0 || version != StateVersion || stateSize != size)
+        return false;
+
+    visitState(*this, reader);
+
+    // The video format decides the Game Gear ports
+    buildPortMaps();
+    buildPageTables();
+
+    // The watched loop and the interrupt schedule belong to the replaced state
+    idleLoop.address = -1;
+    scheduleInterrupt();
+    return true;
+}
+
+bool sms::saveStateFile(std::string path) {
+    std::vector<uint8_t> data(getStateSize());
+    saveState(data.data());
+
+    std::fstream file(path, std::fstream::binary | std::fstream::out | std::fstream::trunc);
+
+    if(!file.good())
+        return false;
+
+    file.write((char*)data.data(), data.size());
+    return file.good();
+}
+
+bool sms::loadStateFile(std::string path) {
+    std::fstream file(path, std::fstream::binary | std::fstream::in);
+
+    if(!file.good())
+        return false;
+
+    file.seekg(0, file.end);
+    size_t size = file.tellg();
+    file.seekg(0, file.beg);
+
+    std::vector<uint8_t> data(size);
+    file.read((char*)data.data(), size);
+
+    if(!file.good())
+        return false;
+
+    return loadState(data.data(), size);
+}
\ No newline at end of file
@@ -1,8 +1,21 @@
 #include "sms.h"
+#include "wav.h"
+#include "movie.h"
+#include "hotspots.h"
 #include <iostream>
 #include <fstream>
 #include <functional>
 #include <cstring>
+#include <climits>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SMS_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 sms::sms() {
     using namespace std::placeholders;
@@ -11,14 +24,25 @@ sms::sms() {
     cpu.port_write = std::bind(&sms::port_write, this, _1, _2);
     cpu.mapper_read = std::bind(&sms::mapper_read, this, _1);
     cpu.mapper_write = std::bind(&sms::mapper_write, this, _1, _2);
+    cpu.interrupt_changed = std::bind(&sms::scheduleInterrupt, this);
+    cpu.event_cycles = std::bind(&sms::getEventCycles, this);
+    cpu.port_write_block = std::bind(&sms::port_write_block, this, _1, _2, _3, _4);
+    cpu.mapper_copy_block = std::bind(&sms::mapper_copy_block, this, _1, _2, _3, _4);
+    cpu.fetchPage = readPage;
 
     // Memory
     rom = NULL;
     romSize = 0;
     romHeader = -1;
+    romMapped = false;
+    romWritable = false;
     std::memset(ram, 0, 8 * 1024);
-    std::memset(sram[0], 0, 16 * 1024);
-    std::memset(sram[1], 0, 16 * 1024);
+    std::memset(sramBuffer[0], 0, 16 * 1024);
+    std::memset(sramBuffer[1], 0, 16 * 1024);
+    sram = sramBuffer;
+    sramMapped = false;
+    sramDirty = 0;
+    sramPageSize = 4096;
 
     // Initialize the slot indices
     mapperOptions = 0;
@@ -31,24 +55,94 @@ sms::sms() {
     joypad2 = 0xFF;
     joypadStart = 0xFF;
 
-    // Rendering
-    frame = NULL;
+    breakpoint = -1;
+    breakpointHit = false;
+    invalidOpcodeAddress = -1;
+    debugConsole = &std::cout;
+
+    // Audio
+    audioCapture = NULL;
+
+    movie = NULL;
+    hotspots = NULL;
+    frameClock = 0;
+    nextInput = INT_MAX;
+    nextIrqCycle = 0;
+    std::memset(&idleLoop, 0, sizeof(idleLoop));
+    idleLoop.address = -1;
+
+    buildPortMaps();
+    buildPageTables();
 }
 
 sms::~sms() {
-    
-    if(rom)
+    unloadSram();
+    unloadRom();
+}
+
+void sms::unloadRom() {
+
+    if(rom) {
+
+#ifdef SMS_MMAP
+        if(romMapped)
+            munmap(rom, romSize);
+        else
+            delete [] rom;
+#else
         delete [] rom;
+#endif
+    }
+    rom = NULL;
+    romSize = 0;
+    romMapped = false;
+    romWritable = false;
+    romDecode.reset();
+
+    buildPageTables();
+}
+
+bool sms::shareDecode(sms& source) {
+
+    if(!rom || !source.romDecode || romSize != source.romSize || std::memcmp(rom, source.rom, romSize) != 0)
+        return false;
 
-    if(frame)
-        SDL_DestroyTexture(frame);
+    romDecode = source.romDecode;
+    buildPageTables();
+    return true;
 }
 
 bool sms::loadRom(std::string romPath) {
+    unloadRom();
 
-    // Load the contents of rom
-    romSize = 0;
+#ifdef SMS_MMAP
+
+    // Map the contents of rom, pages are shared until written
+    int fd = open(romPath.c_str(), O_RDONLY);
+
+    if(fd < 0)
+        return false;
+
+    struct stat info;
+
+    if(fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(data == MAP_FAILED)
+        return false;
+
+    rom = (uint8_t*)data;
+    romSize = info.st_size;
+    romMapped = true;
+
+#else
 
+    // Load the contents of rom
     std::fstream file(romPath, std::fstream::binary | std::fstream::in);
 
     if(!file.good()) {
@@ -59,33 +153,28 @@ bool sms::loadRom(std::string romPath) {
     romSize = file.tellg();
     file.seekg(0, file.beg);
 
+    if(romSize <= 0) {
+        romSize = 0;
+        return false;
+    }
+
     rom = new uint8_t[romSize];
+    romWritable = true;
     file.read((char*)rom, romSize);
 
     file.close();
 
-    // Check possible locations for trademark
-    romHeader = -1;
-
-    if(romSize >= 0x8000) {
-        std::string tm((char*)(&rom[0x7ff0]), 8);
-
-        if(tm == "TMR SEGA")
-            romHeader = 0x7ff0;
-    }
+#endif
 
-    if(romSize >= 0x4000) {
-        std::string tm((char*)(&rom[0x3FF0]), 8);
+    // Check possible locations for trademark, the lowest one wins
+    const int headerOffsets[3] { 0x7ff0, 0x3ff0, 0x1ff0 };
 
-        if(tm == "TMR SEGA")
-            romHeader = 0x3FF0;
-    }
+    romHeader = -1;
 
-    if(romSize >= 0x2000) {
-        std::string tm((char*)(&rom[0x1FF0]), 8);
+    for(int offset : headerOffsets) {
 
-        if(tm == "TMR SEGA")
-            romHeader = 0x1FF0;
+        if(romSize >= offset + 0x10 && std::memcmp(&rom[offset], "TMR SEGA", 8) == 0)
+            romHeader = offset;
     }
 
     if(romHeader == -1)
@@ -99,69 +188,392 @@ bool sms::loadRom(std::string romPath) {
         case 0x6: gpu.videoFormat = TMS9918A::GAMEGEAR_NTSC; break;
         case 0x7: gpu.videoFormat = TMS9918A::GAMEGEAR_NTSC; break;
     }
+    buildPortMaps();
+    buildPageTables();
+    idleLoop.address = -1;
+    scheduleInterrupt();
 
     return true;
 }
 
-int sms::update(SDL_Renderer* renderer, SDL_AudioStream* stream) {
+void sms::scheduleInterrupt() {
+
+    cpu.intLine = gpu.canSendInterrupt();
+
+    if(cpu.intLine) {
+
+        // A raised request waits for the cpu to let it in, the cpu takes it itself at the end of EI
+        bool taken = cpu.IFF1 || cpu.haltState == Z80::HALT_WAIT;
+        nextIrqCycle = (taken) ? frameClock : INT_MAX;
+
+    }else {
+
+        // Rounded up, the gpu runs 3 ticks every 2 cycles
+        int ticks = gpu.getInterruptTicks();
+        nextIrqCycle = (ticks == INT_MAX) ? INT_MAX : frameClock + (ticks * 2 + 2) / 3;
+    }
+}
+
+int sms::getEventCycles() {
+
+    // Due interrupts and breakpoints are checked after every instruction
+    if(nextIrqCycle <= frameClock || breakpoint == cpu.programCounter)
+        return 0;
+
+    // Rounded up, the gpu runs 3 ticks every 2 cycles
+    int cycles = (gpu.getEventTicks() * 2 + 2) / 3;
+
+    return std::max(0, std::min(cycles, nextInput - frameClock));
+}
+
+void sms::getLoopState(uint8_t* state) {
+    uint8_t* ptr = state;
+
+    auto add = [&ptr](const void* data, size_t size) {
+        std::memcpy(ptr, data, size);
+        ptr += size;
+    };
+
+    add(cpu.reg, sizeof(cpu.reg));
+    add(&cpu.indexRegisterX, sizeof(cpu.indexRegisterX));
+    add(&cpu.indexRegisterY, sizeof(cpu.indexRegisterY));
+    add(&cpu.stackPointer, sizeof(cpu.stackPointer));
+    add(&cpu.interruptMode, sizeof(cpu.interruptMode));
+    add(&cpu.IFF1, sizeof(cpu.IFF1));
+    add(&cpu.IFF2, sizeof(cpu.IFF2));
+    add(&cpu.haltState, sizeof(cpu.haltState));
+    add(&cpu.eiState, sizeof(cpu.eiState));
+
+    // What a status port read returns and clears
+    add(&gpu.status, sizeof(gpu.status));
+    add(&gpu.controlOffset, sizeof(gpu.controlOffset));
+    add(&gpu.requestFrameInterrupt, sizeof(gpu.requestFrameInterrupt));
+    add(&gpu.requestLineInterrupt, sizeof(gpu.requestLineInterrupt));
+}
+
+int sms::skipIdleLoop() {
+    int address = cpu.loopBranch;
+    cpu.loopBranch = -1;
+
+    // An interrupt was taken instead
+    if(cpu.programCounter != address) {
+        idleLoop.address = -1;
+        return 0;
+    }
+
+    uint8_t state[sizeof(idleLoop.state)] {};
+    getLoopState(state);
+
+    int skipped = 0;
+
+    // A pass that changed nothing and saw no event repeats exactly until the next event
+    if(idleLoop.address == address && !cpu.loopSideEffect && breakpoint < 0 &&
+        idleLoop.ticks < idleLoop.eventTicks && std::memcmp(state, idleLoop.state, sizeof(state)) == 0) {
+
+        int passes = (gpu.getEventTicks() - 1) / idleLoop.ticks;
+
+        if(nextInput != INT_MAX)
+            passes = std::min(passes, (nextInput - frameClock) / idleLoop.cycles);
+
+        if(passes > 0) {
+
+            gpu.advance(passes * idleLoop.ticks);
+
+            // R counts up by the same amount every pass, bit 7 stays once set
+            int refresh = cpu.memoryRefresh + passes * ((cpu.memoryRefresh - idleLoop.refresh) & 0x7f);
+            cpu.memoryRefresh = (refresh < 0x80) ? refresh : (0x80 | (refresh & 0x7f));
+
+            skipped = passes * idleLoop.cycles;
+        }
+    }
+
+    // Watch the next pass
+    idleLoop.address = address;
+    idleLoop.cycles = 0;
+    idleLoop.ticks = 0;
+    idleLoop.eventTicks = gpu.getEventTicks();
+    idleLoop.refresh = cpu.memoryRefresh;
+    std::memcpy(idleLoop.state, state, sizeof(state));
+    cpu.loopSideEffect = false;
+
+    return skipped;
+}
+
+int sms::update(uint8_t output) {
     bool clearVBlank = false;
     int totalClock = 0;
 
+    breakpointHit = false;
+    gpu.renderEnable = (output & Output_Video);
+
+    // Movie inputs land on the same cycle they were recorded at
+    nextInput = (movie) ? movie->replay(*this, frameClock) : INT_MAX;
+
     while(!clearVBlank) {
-        int clock = cpu.cycle();
 
-        // Invalid opcode found
+        if(frameClock >= nextInput)
+            nextInput = movie->replay(*this, frameClock);
+
+        // Straight runs of instructions until the next event, single steps around it
+        int budget = (breakpoint < 0) ? getEventCycles() : 0;
+        int clock = (budget > 0) ? cpu.run(budget) : 0;
+
+        if(clock == 0)
+            clock = cpu.cycle();
+
+        // Invalid opcode found, kept for the caller to report
         if(clock <= 0) {
+            invalidOpcodeAddress = cpu.programCounter;
+
+            for(int i = 0; i < 4; i ++)
+                invalidOpcode[i] = cpu.mapper_read(cpu.programCounter+i);
 
-            uint8_t byte[4] {
-                cpu.mapper_read(cpu.programCounter),
-                cpu.mapper_read(cpu.programCounter+1),
-                cpu.mapper_read(cpu.programCounter+2),
-                cpu.mapper_read(cpu.programCounter+3)
-            };
-            std::cout << std::hex << (int)cpu.programCounter << ": " << (int)byte[0] << " " << (int)byte[1] << " " << (int)byte[2] << " " << (int)byte[3] << "\n";
             throw std::runtime_error("INVALID OPCODE");
         } 
 
-        // Cycle the gpu device
-        for(int i = 0; i < clock * 3 / 2; i ++) {
+        // Cycle the gpu device, bulk runs round each instruction like single steps
+        int ticks = (clock * 3 - cpu.oddInstructions) / 2;
+
+        // Ticks short of the next event only move the counters
+        int quiet = std::min(ticks, gpu.getEventTicks() - 1);
+        gpu.advance(quiet);
+
+        for(int i = quiet; i < ticks; i ++) {
 
             if(gpu.cycle())
                 clearVBlank = true;
+        }
 
-            if(gpu.vCounter == 192 && gpu.hCounter == 0)
-                draw(renderer);
+        totalClock += clock;
+        frameClock += clock;
+
+        // Dispatch interrupts from gpu to cpu, only once due instead of after every instruction
+        if(frameClock >= nextIrqCycle) {
+
+            if(gpu.canSendInterrupt())
+                cpu.signalINT();
+
+            scheduleInterrupt();
         }
 
-        // Dispatch interrupts from gpu to cpu
-        if(gpu.canSendInterrupt()) 
-            cpu.signalINT();
+        idleLoop.cycles += clock;
+        idleLoop.ticks += ticks;
 
-        totalClock += clock;
+        // Polling loops that only an event can end are skipped up to it
+        if(cpu.loopBranch >= 0) {
+            int skipped = skipIdleLoop();
+
+            totalClock += skipped;
+            frameClock += skipped;
+
+#ifdef Z80_PROFILE
+            if(hotspots)
+                hotspots->idle(skipped);
+#endif
+        }
+
+        if(cpu.programCounter == breakpoint) {
+            breakpointHit = true;
+            break;
+        }
+    }
+
+    if(clearVBlank) {
+        frameClock = 0;
+        scheduleInterrupt();
+        attachSram(false);
+
+        if(movie)
+            movie->endFrame();
     }
 
-    // Generate the sound waves
-    std::vector<float> samples(totalClock / 15);
-    for(int i = 0; i < samples.size(); i ++ ) {
-        psg.cycle();
-        samples[i] = psg.getSample();
+    // Generate the sound waves as interleaved stereo frames
+    int frames = totalClock / 15;
+
+    if(output & Output_Audio) {
+        audioSamples.resize(frames * 2);
+        psg.render(audioSamples.data(), frames);
+
+        if(audioCapture)
+            audioCapture->write(audioSamples.data(), audioSamples.size());
+
+    }else {
+        audioSamples.clear();
+        psg.advance(frames);
     }
 
     // Calculate the theoretical time(ms) to clear a VBlank 
-    int time = totalClock * 15 * 1000 / getMasterClock();
+    return totalClock * 15 * 1000 / getMasterClock();
+}
+
+bool sms::loadSram(std::string path) {
+    unloadSram();
+    sramPath = path;
+
+    // Existing saves are mapped right away, new ones wait for the game to enable its ram
+    std::fstream file(sramPath, std::fstream::binary | std::fstream::in);
+
+    if(!file.good())
+        return true;
+
+    file.close();
+    return mapSram();
+}
+
+#ifdef SMS_MMAP
+
+// Map the whole save file, shorter ones are padded with zeros, NULL when it can not be
+static void* mapSaveFile(std::string path, size_t size) {
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+
+    struct stat info;
+    bool valid = fd >= 0 && fstat(fd, &info) == 0;
+
+    if(valid && info.st_size < (off_t)size)
+        valid = ftruncate(fd, size) == 0;
+
+    void* data = (valid) ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+
+    if(fd >= 0)
+        close(fd);
+
+    return (data == MAP_FAILED) ? NULL : data;
+}
+
+#endif
+
+bool sms::mapSram() {
+
+#ifdef SMS_MMAP
+
+    void* data = mapSaveFile(sramPath, sizeof(sramBuffer));
+
+    // Give up on the save file rather than retrying on every mapper write
+    if(!data) {
+        sramPath.clear();
+        return false;
+    }
+    sramPageSize = sysconf(_SC_PAGESIZE);
+    sram = (uint8_t (*)[16 * 1024])data;
+
+#else
 
-    // Using time to determine format of the sample stream
-    if(time > 0) {
-        SDL_AudioSpec spec;
-        spec.channels = 1;
-        spec.format = SDL_AUDIO_F32;
-        spec.freq = 1000 * samples.size() / time;
-        SDL_SetAudioStreamFormat(stream, &spec, NULL);
-        SDL_PutAudioStreamData(stream, samples.data(), samples.size() * sizeof(float));
-        SDL_FlushAudioStream(stream);
+    std::fstream file(sramPath, std::fstream::binary | std::fstream::in);
+
+    if(file.good())
+        file.read((char*)sramBuffer, sizeof(sramBuffer));
+
+#endif
+
+    sramMapped = true;
+    buildPageTables();
+    return true;
+}
+
+void sms::createSram() {
+
+#ifdef SMS_MMAP
+    sramMapping = std::async(std::launch::async, mapSaveFile, sramPath, sizeof(sramBuffer));
+#else
+    // Without mappings the save is only written on unload
+    sramMapped = true;
+#endif
+}
+
+void sms::attachSram(bool wait) {
+
+    if(!sramMapping.valid())
+        return;
+
+    if(!wait && sramMapping.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
+
+#ifdef SMS_MMAP
+    void* data = sramMapping.get();
+
+    if(!data) {
+        sramPath.clear();
+        return;
     }
+    sramPageSize = sysconf(_SC_PAGESIZE);
+
+    // The new save starts from what the game has written so far
+    std::memcpy(data, sramBuffer, sizeof(sramBuffer));
+    sramDirty = 0xFFFFFFFF;
+
+    sram = (uint8_t (*)[16 * 1024])data;
+    sramMapped = true;
+    buildPageTables();
+#endif
+}
 
-    return time;
+void sms::writeSram(int offset, uint8_t data) {
+    ((uint8_t*)sram)[offset] = data;
+    sramDirty |= 1 << (offset / sramPageSize);
+}
+
+void sms::flushSram() {
+
+    if(!sramMapped || sramDirty == 0)
+        return;
+
+#ifdef SMS_MMAP
+    int size = sizeof(sramBuffer);
+
+    for(int offset = 0; offset < size; offset += sramPageSize) {
+
+        if(sramDirty & (1 << (offset / sramPageSize)))
+            msync((uint8_t*)sram + offset, std::min(sramPageSize, size - offset), MS_ASYNC);
+    }
+    sramDirty = 0;
+#endif
+}
+
+void sms::unloadSram() {
+
+    // A save file still being made is taken over so the game's writes reach it
+    attachSram(true);
+
+    if(sramMapped) {
+
+#ifdef SMS_MMAP
+        flushSram();
+
+        // Keep the contents for the machine, the mapping goes away
+        std::memcpy(sramBuffer, sram, sizeof(sramBuffer));
+        munmap(sram, sizeof(sramBuffer));
+
+#else
+        // Without mappings the whole save is written on the way out
+        if(sramDirty) {
+            std::fstream file(sramPath, std::fstream::binary | std::fstream::out | std::fstream::trunc);
+            file.write((char*)sramBuffer, sizeof(sramBuffer));
+        }
+#endif
+    }
+    sram = sramBuffer;
+    sramMapped = false;
+    sramDirty = 0;
+    sramPath.clear();
+
+    buildPageTables();
+}
+
+void sms::writeRom(int offset, uint8_t data) {
+
+    // Other machines may share the decode of the unwritten rom
+    romDecode.reset();
+
+    // Only now does the mapping get its own copy of the written pages
+    if(!romWritable) {
+
+#ifdef SMS_MMAP
+        if(mprotect(rom, romSize, PROT_READ | PROT_WRITE) != 0)
+            return;
+#endif
+        romWritable = true;
+    }
+    rom[offset] = data;
 }
 
 uint8_t sms::mapper_read(uint16_t addr) {
@@ -222,43 +634,44 @@ uint8_t sms::mapper_read(uint16_t addr) {
 }
 
 void sms::mapper_write(uint16_t addr, uint8_t data) {
+    cpu.loopSideEffect = true;
 
     // First 1kb is always the first 1kb of rom
     if(0x0000 <= addr && addr <= 0x03ff) {
 
         if(mapperOptions & ROM_EnableWrite) {
-            rom[addr] = data;
+            writeRom(addr, data);
         }
 
     // Slot0 of 16kb rom
     }else if(0x0400 <= addr && addr <= 0x3fff) {
         
         if(mapperOptions & ROM_EnableWrite) {
-            rom[(mapperBankSelect[0] * 16*1024 + addr) % romSize] = data;
+            writeRom((mapperBankSelect[0] * 16*1024 + addr) % romSize, data);
         }
 
     // Slot1 of 16kb rom
     }else if(0x4000 <= addr && addr <= 0x7fff) {
 
         if(mapperOptions & ROM_EnableWrite) {
-            rom[(mapperBankSelect[1] * 16*1024 + addr - 0x4000) % romSize] = data;
+            writeRom((mapperBankSelect[1] * 16*1024 + addr - 0x4000) % romSize, data);
         }
     
     // Slot2 of 16kb rom/ram
     }else if(0x8000 <= addr && addr <= 0xbfff) {
         
         if(mapperOptions & SRAM_EnableSlot2) {
-            sram[(mapperOptions & SRAM_BankSelect) >> 2][addr - 0x8000] = data;
+            writeSram(((mapperOptions & SRAM_BankSelect) >> 2) * 16*1024 + addr - 0x8000, data);
 
         }else if(mapperOptions & ROM_EnableWrite) {
-            rom[(mapperBankSelect[2] * 16*1024 + addr - 0x8000) % romSize] = data; 
+            writeRom((mapperBankSelect[2] * 16*1024 + addr - 0x8000) % romSize, data);
         }
 
     // System RAM
     }else if(0xc000 <= addr && addr <= 0xdfff) {
 
         if(mapperOptions & SRAM_EnableRAM) {
-            sram[(mapperOptions & SRAM_BankSelect) >> 2][addr - 0xc000] = data;
+            writeSram(((mapperOptions & SRAM_BankSelect) >> 2) * 16*1024 + addr - 0xc000, data);
 
         }else {
             ram[addr - 0xc000] = data;
@@ -268,7 +681,7 @@ void sms::mapper_write(uint16_t addr, uint8_t data) {
     }else if(0xe000 <= addr && addr <= 0xfffb) {
 
         if(mapperOptions & SRAM_EnableRAM) {
-            sram[(mapperOptions & SRAM_BankSelect) >> 2][addr - 0xc000] = data;
+            writeSram(((mapperOptions & SRAM_BankSelect) >> 2) * 16*1024 + addr - 0xc000, data);
 
         }else {
             ram[addr - 0xe000] = data;
@@ -278,6 +691,12 @@ void sms::mapper_write(uint16_t addr, uint8_t data) {
     }else if(addr == 0xfffc) {
         mapperOptions = data;
 
+        // The save file is created once the game shows it uses the cartridge ram
+        if((data & (SRAM_EnableSlot2 | SRAM_EnableRAM)) && !sramMapped && !sramPath.empty() && !sramMapping.valid())
+            createSram();
+
+        buildPageTables();
+
     // Mapper Bank Selects
     }else if(0xfffd <= addr && addr <= 0xffff) {
         uint8_t shift = 0;
@@ -288,86 +707,279 @@ void sms::mapper_write(uint16_t addr, uint8_t data) {
             case 3: shift = 8; break;
         }
         mapperBankSelect[addr - 0xfffd] = data + shift;
+        buildPageTables();
     }
 }
 
-uint8_t sms::port_read(uint16_t addr) {
-    addr %= 256;
+void sms::buildPageTables() {
+    int bank = ((mapperOptions & SRAM_BankSelect) >> 2);
 
-    if(gpu.videoFormat == TMS9918A::GAMEGEAR_NTSC && addr == 0x00) {
-        return joypadStart;
+    // Rom instructions are decoded once, but only while the rom can not be written
+    // The cache is kept until replaced, the instruction enabling writes may still be decoding into it
+    if(!rom || (mapperOptions & ROM_EnableWrite)) {
+        cpu.decodeBase = NULL;
 
-    }else if(addr >= 0x00 && addr <= 0x3E && addr % 2 == 0) {
-        // Memory control, unneeded
-        return 0xFF;
+    }else if(cpu.decodeBase != rom || !romDecode || cpu.decodeCache != romDecode) {
 
+        if(!romDecode)
+            romDecode = std::make_shared<std::vector<uint8_t>>(romSize, 0);
+
+        cpu.decodeBase = rom;
+        cpu.decodeCache = romDecode;
+    }
 
-    }else if(addr >= 0x01 && addr <= 0x3F && addr % 2 == 1) {
-        // I/O Port Control, unneeded
-        return 0xFF;
+    for(int page = 0; page < 64; page ++) {
+        int addr = page * 1024;
 
+        readPage[page] = NULL;
+        writePage[page] = NULL;
 
-    }else if(addr >= 0x40 && addr <= 0x7E && addr % 2 == 0) {
-        return gpu.readVCounter();
+        // Rom banks wrap by the rom size, pages only work while it wraps on whole pages
+        bool romPages = rom && romSize % 1024 == 0;
 
+        // First 1kb is always the first 1kb of rom
+        if(addr <= 0x03ff) {
+            if(romPages) readPage[page] = rom + addr;
 
-    }else if(addr >= 0x41 && addr <= 0x7F && addr % 2 == 1) {
-        return gpu.readHCounter();
+        // Slot0 and Slot1 of 16kb rom
+        }else if(addr <= 0x7fff) {
+            int slot = addr / (16*1024);
+            if(romPages) readPage[page] = rom + (mapperBankSelect[slot] * 16*1024 + addr - slot * 16*1024) % romSize;
 
+        // Slot2 of 16kb rom/ram
+        }else if(addr <= 0xbfff) {
 
-    }else if(addr >= 0x80 && addr <= 0xBE && addr % 2 == 0) {
-        return gpu.readDataPort();
+            if(mapperOptions & SRAM_EnableSlot2) {
+                readPage[page] = sram[bank] + addr - 0x8000;
 
+            }else if(romPages) {
+                readPage[page] = rom + (mapperBankSelect[2] * 16*1024 + addr - 0x8000) % romSize;
+            }
 
-    }else if(addr >= 0x81 && addr <= 0xBF && addr % 2 == 1) {
-        return gpu.readControlPort();
+        // System RAM and its mirror, the last page holds the mapper registers
+        }else if(page < 63) {
 
+            if(mapperOptions & SRAM_EnableRAM) {
+                readPage[page] = sram[bank] + addr - 0xc000;
 
-    }else if(addr >= 0xC0 && addr <= 0xFE && addr % 2 == 0) {
-        return joypad1;
+            }else {
+                readPage[page] = ram + (addr - 0xc000) % (8 * 1024);
+                writePage[page] = readPage[page];
+            }
+        }
+    }
+}
+
+int sms::mapper_copy_block(uint16_t dst, uint16_t src, int step, int count) {
+
+    // The instruction has to be decoded again once its own opcode is written over
+    uint8_t* opcode[2] {
+        readPage[cpu.programCounter >> 10],
+        readPage[(uint16_t)(cpu.programCounter + 1) >> 10]
+    };
+
+    if(!opcode[0] || !opcode[1])
+        return 0;
+
+    opcode[0] += cpu.programCounter & 0x3ff;
+    opcode[1] += (cpu.programCounter + 1) & 0x3ff;
+
+    int done = 0;
+    cpu.loopSideEffect = true;
+
+    while(done < count) {
+        uint8_t* from = readPage[src >> 10];
+        uint8_t* to = readPage[dst >> 10];
+
+        // Mapper registers are left to single steps
+        if(!to)
+            break;
+
+        // Cartridge ram and rom writes go one byte at a time through the mapper
+        if(!from || !writePage[dst >> 10]) {
+            to += dst & 0x3ff;
+
+            if(to == opcode[0] || to == opcode[1])
+                break;
+
+            mapper_write(dst, mapper_read(src));
+
+            src += step;
+            dst += step;
+            done ++;
+            continue;
+        }
 
+        from += src & 0x3ff;
+        to += dst & 0x3ff;
 
-    }else if(addr >= 0xC1 && addr <= 0xFF && addr % 2 == 1) {
-        return joypad2;
+        // Bytes left before either side leaves its page
+        int span = (step > 0) ?
+            std::min(1024 - (src & 0x3ff), 1024 - (dst & 0x3ff)) :
+            std::min((src & 0x3ff) + 1, (dst & 0x3ff) + 1);
 
+        span = std::min(span, count - done);
+
+        // Stop short of the opcode
+        bool cut = false;
+
+        for(uint8_t* op : opcode) {
+            intptr_t distance = ((intptr_t)op - (intptr_t)to) * step;
+
+            if(distance >= 0 && distance < span) {
+                span = distance;
+                cut = true;
+            }
+        }
+
+        // Lowest address of each side
+        uint8_t* fromLow = (step > 0) ? from : from - span + 1;
+        uint8_t* toLow = (step > 0) ? to : to - span + 1;
+
+        // Overlapping runs such as fills repeat bytes already copied, so go in order
+        if(toLow + span <= fromLow || fromLow + span <= toLow) {
+            std::memcpy(toLow, fromLow, span);
+
+        }else {
+
+            for(int i = 0; i < span; i ++)
+                to[i * step] = from[i * step];
+        }
+
+        src += step * span;
+        dst += step * span;
+        done += span;
+
+        if(cut)
+            break;
     }
-    return 0;
+    return done;
+}
+
+void sms::buildPortMaps() {
+
+    for(int addr = 0; addr < 256; addr ++) {
+        bool odd = addr % 2 == 1;
+
+        // Only the top two bits and the lowest bit of a port are decoded
+        switch(addr & 0b11000000) {
+
+            case 0x00:
+                portReadMap[addr] = Device_None;
+                portWriteMap[addr] = (odd) ? Device_IOControl : Device_None;
+                break;
+
+            case 0x40:
+                portReadMap[addr] = (odd) ? Device_HCounter : Device_VCounter;
+                portWriteMap[addr] = Device_PSG;
+                break;
+
+            case 0x80:
+                portReadMap[addr] = (odd) ? Device_VDPControl : Device_VDPData;
+                portWriteMap[addr] = (odd) ? Device_VDPControl : Device_VDPData;
+                break;
+
+            case 0xC0:
+                portReadMap[addr] = (odd) ? Device_JoypadB : Device_JoypadA;
+                portWriteMap[addr] = Device_None;
+                break;
+        }
+    }
+
+    // Game Gear start button and stereo registers
+    if(gpu.videoFormat == TMS9918A::GAMEGEAR_NTSC) {
+        portReadMap[0x00] = Device_GameGearStart;
+        portWriteMap[0x06] = Device_GameGearStereo;
+    }
+
+    // SDSC, debug console
+    portWriteMap[0xFD] = Device_DebugConsole;
+}
+
+uint8_t sms::port_read(uint16_t addr) {
+
+    // Counters and vram reads differ every time, so loops polling them are never idle
+    switch(portReadMap[addr % 256]) {
+        case Device_VCounter:       cpu.loopSideEffect = true; return gpu.readVCounter();
+        case Device_HCounter:       cpu.loopSideEffect = true; return gpu.readHCounter();
+        case Device_VDPData:        cpu.loopSideEffect = true; return gpu.readDataPort();
+        case Device_VDPControl:
+        {
+            // Reading the status clears the requests
+            uint8_t status = gpu.readControlPort();
+            scheduleInterrupt();
+            return status;
+        }
+        case Device_JoypadA:        return joypad1;
+        case Device_JoypadB:        return joypad2;
+        case Device_GameGearStart:  return joypadStart;
+    }
+
+    // Memory and I/O control, unneeded
+    return 0xFF;
 }
 
 void sms::port_write(uint16_t addr, uint8_t data) {
-    addr %= 256;
+    cpu.loopSideEffect = true;
 
-    if(addr == 0xFD) {
-        // SDSC, debug console
-        std::cout << (char)data;
+    switch(portWriteMap[addr % 256]) {
 
-    } else if(addr >= 0x01 && addr <= 0x3F && addr % 2 == 1) {
-        uint8_t joyB_TH_val = (data & 0b10000000) >> 7;
-        uint8_t joyB_TR_val = (data & 0b01000000) >> 6;
-        uint8_t joyA_TH_val = (data & 0b00100000) >> 5;
-        uint8_t joyA_TR_val = (data & 0b00010000) >> 4;
-        uint8_t joyB_TH_dir = (data & 0b00001000) >> 3;
-        uint8_t joyB_TR_dir = (data & 0b00000100) >> 2;
-        uint8_t joyA_TH_dir = (data & 0b00000010) >> 1;
-        uint8_t joyA_TR_dir = (data & 0b00000001) >> 0;
+        case Device_IOControl:
+        {
+            uint8_t joyB_TH_val = (data & 0b10000000) >> 7;
+            uint8_t joyB_TR_val = (data & 0b01000000) >> 6;
+            uint8_t joyA_TH_val = (data & 0b00100000) >> 5;
+            uint8_t joyA_TR_val = (data & 0b00010000) >> 4;
+            uint8_t joyB_TH_dir = (data & 0b00001000) >> 3;
+            uint8_t joyB_TR_dir = (data & 0b00000100) >> 2;
+            uint8_t joyA_TH_dir = (data & 0b00000010) >> 1;
+            uint8_t joyA_TR_dir = (data & 0b00000001) >> 0;
+
+            applyJoyPadControl(Joypad_B_TH, joyB_TH_val);
+            applyJoyPadControl(Joypad_B_TR, joyB_TR_val);
+            applyJoyPadControl(Joypad_A_TH, joyA_TH_val);
+            applyJoyPadControl(Joypad_A_TR, joyA_TR_val);
+            break;
+        }
+
+        case Device_PSG:            psg.write(data); break;
+        case Device_VDPData:        gpu.writeDataPort(data); break;
+        case Device_VDPControl:
+        {
+            gpu.writeControlPort(data);
 
-        setJoyPadControl(Joypad_B_TH, joyB_TH_val);
-        setJoyPadControl(Joypad_B_TR, joyB_TR_val);            
-        setJoyPadControl(Joypad_A_TH, joyA_TH_val);
-        setJoyPadControl(Joypad_A_TR, joyA_TR_val);    
+            // Registers 0 and 1 enable the interrupts, register 10 reloads the line counter
+            if(gpu.controlOffset == 0 && gpu.getControlCode() == 2) {
+                uint8_t index = gpu.getControlRegisterIndex();
 
-    }else if(addr >= 0x40 && addr <= 0x7F) {
-        psg.write(data);
+                if(index == 0x0 || index == 0x1 || index == 0xA)
+                    scheduleInterrupt();
+            }
+            break;
+        }
+        case Device_GameGearStereo: psg.stereo = data; break;
 
+        case Device_DebugConsole:
+        {
+            if(debugConsole)
+                (*debugConsole) << (char)data;
+            break;
+        }
+    }
+}
 
-    }else if(addr >= 0x80 && addr <= 0xBE && addr % 2 == 0) {
-        gpu.writeDataPort(data);
+bool sms::port_write_block(uint16_t addr, uint16_t ptr, int step, int count) {
 
-        
-    }else if(addr >= 0x81 && addr <= 0xBF && addr % 2 == 1) {
-        gpu.writeControlPort(data);
+    if(portWriteMap[addr % 256] != Device_VDPData)
+        return false;
 
+    cpu.loopSideEffect = true;
+
+    for(int i = 0; i < count; i ++) {
+        gpu.writeDataPort(mapper_read(ptr));
+        ptr += step;
     }
+    return true;
 }
 
 int sms::getMasterClock() {
@@ -384,7 +996,23 @@ int sms::getMasterClock() {
     return 1;
 }
 
+int sms::getAudioFrequency() {
+
+    // One sample is generated every 15 cpu cycles, the cpu runs at a 15th of the master clock
+    return getMasterClock() / 225;
+}
+
 void sms::setJoyPadControl(uint8_t control, bool val) {
+
+    if(movie && !movie->input(control, val, frameClock))
+        return;
+
+    applyJoyPadControl(control, val);
+}
+
+void sms::applyJoyPadControl(uint8_t control, bool val) {
+    cpu.loopSideEffect = true;
+
     uint8_t* ptr = NULL;
     uint8_t bit = 0;
 
@@ -433,23 +1061,27 @@ void sms::setJoyPadControl(uint8_t control, bool val) {
     }
 }
 
-void sms::draw(SDL_Renderer* renderer) {
+uint64_t sms::getRomHash() {
+    uint64_t hash = 14695981039346656037ull;
 
-    if(!frame) {
-        frame = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, 256, 240);
-        SDL_SetTextureScaleMode(frame, SDL_SCALEMODE_NEAREST);
+    for(int i = 0; i < romSize; i ++) {
+        hash ^= rom[i];
+        hash *= 1099511628211ull;
     }
+    return hash;
+}
 
-    SDL_UpdateTexture(frame, NULL, gpu.frameBuffer, sizeof(int) * 256);
+uint64_t sms::getFrameHash() {
+    uint64_t hash = 14695981039346656037ull;
 
-    SDL_FRect dst {
-        0.f, 
-        0.f, 
-        256.f, 
-        240.f, 
-    };
+    // FNV-1a over the pixels shown on screen
+    for(int y = 0; y < gpu.getScreenHeight(); y ++) {
+        const int* row = &gpu.frameBuffer[(y + gpu.getScreenOffsetY()) * 256 + gpu.getScreenOffsetX()];
 
-    SDL_RenderTexture(renderer, frame, NULL, &dst);
-
-    SDL_RenderPresent(renderer);
+        for(int x = 0; x < gpu.getScreenWidth(); x ++) {
+            hash ^= (uint32_t)row[x];
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
 }
\ No newline at end of file
@@ -6,8 +6,14 @@
 #include "SN76489/SN76489.h"
 
 #include <string>
+#include <vector>
+#include <memory>
+#include <future>
+#include <iosfwd>
 
-#include "SDL3/SDL.h"
+struct WavWriter;
+struct Movie;
+struct Hotspots;
 
 struct sms {
 
@@ -21,8 +27,42 @@ struct sms {
     uint8_t* rom = NULL;
     int romSize;
     int romHeader;
+
+    // Rom is a read only file mapping shared between instances, made a private copy on the first write
+    bool romMapped;
+    bool romWritable;
+    void writeRom(int offset, uint8_t data);
+    void unloadRom();
+
+    // Instructions decoded from the rom as loaded, dropped once the rom is written
+    std::shared_ptr<std::vector<uint8_t>> romDecode;
+
+    // Use the decoded instructions of another machine running the same rom, false when the roms differ
+    bool shareDecode(sms& source);
+
     uint8_t ram[8 * 1024];
-    uint8_t sram[2][16 * 1024];
+
+    // Cartridge ram, points into a shared mapping of the save file once there is one
+    uint8_t (*sram)[16 * 1024];
+    uint8_t sramBuffer[2][16 * 1024];
+
+    // Battery backed save file, only created once the game enables its ram
+    std::string sramPath;
+    bool sramMapped;
+    uint32_t sramDirty;
+    int sramPageSize;
+    bool loadSram(std::string path);
+    bool mapSram();
+    void writeSram(int offset, uint8_t data);
+
+    // New save files are made on another thread, the game keeps writing sramBuffer until the mapping is taken over
+    std::future<void*> sramMapping;
+    void createSram();
+    void attachSram(bool wait);
+    void unloadSram();
+
+    // Starts writing back the pages changed since the last flush, never waits on the disk
+    void flushSram();
 
     enum {
         Joypad_B_Down,
@@ -46,6 +86,9 @@ struct sms {
     uint8_t joypadStart;
     void setJoyPadControl(uint8_t control, bool val);
 
+    // Changes the line without going through a movie, for the console driving TH and TR itself
+    void applyJoyPadControl(uint8_t control, bool val);
+
     bool loadRom(std::string romPath);
 
 
@@ -61,6 +104,14 @@ struct sms {
     uint8_t mapper_read(uint16_t addr);
     void mapper_write(uint16_t addr, uint8_t data);
 
+    /* Memory seen through 1kb pages, NULL where bytes have to go through the mapper */
+    uint8_t* readPage[64];
+    uint8_t* writePage[64];
+    void buildPageTables();
+
+    // Repeated copies, returns how many of the bytes were copied
+    int mapper_copy_block(uint16_t dst, uint16_t src, int step, int count);
+
     enum Ports {
         ControllerAPort     = 0xDC,
         ControllerBPort     = 0xDD,
@@ -72,10 +123,104 @@ struct sms {
     uint8_t port_read(uint16_t addr);
     void port_write(uint16_t addr, uint8_t data);
 
-    int update(SDL_Renderer* renderer, SDL_AudioStream* stream);
+    // Repeated writes from memory, only the vdp data port takes them in bulk
+    bool port_write_block(uint16_t addr, uint16_t ptr, int step, int count);
+
+    /* Device behind each of the 256 ports, rebuilt whenever the video format changes */
+    enum PortDevice {
+        Device_None,
+        Device_IOControl,
+        Device_VCounter,
+        Device_HCounter,
+        Device_VDPData,
+        Device_VDPControl,
+        Device_JoypadA,
+        Device_JoypadB,
+        Device_PSG,
+        Device_GameGearStart,
+        Device_GameGearStereo,
+        Device_DebugConsole
+    };
+    uint8_t portReadMap[256];
+    uint8_t portWriteMap[256];
+    void buildPortMaps();
+
+    enum OutputFlags {
+        Output_Video            = 0b00000001,
+        Output_Audio            = 0b00000010,
+        Output_All              = 0b00000011
+    };
+
+    // Emulate a frame, returns the time(ms) the real system would take
+    // Speculative frames can leave out the picture or the audio to run faster
+    int update(uint8_t output = Output_All);
+
+    // Address and bytes of the invalid opcode update() threw on, -1 while none was found
+    int invalidOpcodeAddress;
+    uint8_t invalidOpcode[4];
+
+    // Stop update() early when the program counter reaches this address, -1 to disable
+    int breakpoint;
+    bool breakpointHit;
+
+    // Interleaved stereo samples generated by the last update()
+    std::vector<int16_t> audioSamples;
+
+    // Text written to the SDSC debug console port, NULL to discard
+    std::ostream* debugConsole;
+
+    // Optional copy of the generated audio
+    WavWriter* audioCapture;
+    int getAudioFrequency();
+
+    // Optional recording or replay of the joypad inputs
+    Movie* movie;
+
+    // Optional profile of where the program spends its cycles, set by Hotspots::attach()
+    Hotspots* hotspots;
+
+    // Cycles into the current frame, carried over when update() stops early
+    int frameClock;
+
+    // Clock of the next movie input due in this frame
+    int nextInput;
+
+    // Clock the interrupt line is looked at next, INT_MAX while nothing can raise or let in an interrupt
+    int nextIrqCycle;
+
+    // Called when the video registers, the status or the cpu change when the next interrupt is taken
+    void scheduleInterrupt();
+
+    // Cpu cycles that run out before anything else could observe the machine, 0 while bulk runs are unsafe
+    int getEventCycles();
+
+    /* Polling loop being watched, a pass ending in the same state with no side effect or event repeats until the next event */
+    struct IdleLoop {
+        int address;
+        int cycles;
+        int ticks;
+        int eventTicks;
+        uint8_t refresh;
+        uint8_t state[32];
+    };
+    IdleLoop idleLoop;
+    void getLoopState(uint8_t* state);
+
+    // Skips the passes due before the next event, returns the cycles skipped
+    int skipIdleLoop();
+
+    // Hash of the visible area of the frame buffer
+    uint64_t getFrameHash();
+    uint64_t getRomHash();
+
+    /* Save states, a versioned fixed layout snapshot of the whole machine */
+    static const uint32_t StateVersion = 2;
 
-    SDL_Texture* frame;
-    void draw(SDL_Renderer* renderer);
+    size_t getStateSize();
+    void saveState(uint8_t* data);
+    bool loadState(const uint8_t* data, size_t size);
+    bool saveStateFile(std::string path);
+    bool loadStateFile(std::string path);
 
     int getMasterClock();
 };
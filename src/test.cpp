@@ -1,5 +1,6 @@
 #include "Z80/Z80.h"
 #include <filesystem>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include "nlohmann/json.hpp"
@@ -7,6 +8,9 @@
 uint8_t memory[64 * 1024];
 uint8_t port[64 * 1024];
 
+// Every 1kb page of memory for fetching instructions directly
+uint8_t* pages[64];
+
 uint8_t mapper_read(uint16_t addr) {
     return memory[addr];
 }
@@ -25,11 +29,13 @@ void port_write(uint16_t addr, uint8_t data) {
     port[addr] = data;
 }
 
-bool run_tests(Z80& cpu, std::string path) {
+bool run_tests(Z80& cpu, std::string path, bool predecoded) {
     std::fstream file(path);
     nlohmann::json json = nlohmann::json::parse(file);
     file.close();
 
+    cpu.fetchPage = (predecoded) ? pages : NULL;
+
     // Run each test in the json file
     for(auto& test : json) {
         cpu.programCounter      = test["initial"]["pc"];
@@ -76,7 +82,22 @@ bool run_tests(Z80& cpu, std::string path) {
             port_write(addr, data);
         }
 
-        if(!cpu.cycle())
+        // Instructions fetched from a predecoded window around them, run as compiled blocks with Z80_JIT
+        // A new cache for every test drops what was decoded and compiled from the last one
+        if(predecoded) {
+            size_t window = cpu.programCounter & 0xFC00;
+            cpu.decodeBase = memory + window;
+            cpu.decodeCache = std::make_shared<std::vector<uint8_t>>(std::min<size_t>(2048, sizeof(memory) - window), 0);
+        }
+
+        // Same path as the emulator, the run loop and single steps for what it leaves
+        cpu.loopBranch = -1;
+        int clock = cpu.run(1);
+
+        if(!clock)
+            clock = cpu.cycle();
+
+        if(!clock)
             continue; // Unimplemented instruction or illegal
     
         bool ok = true;
@@ -224,20 +245,89 @@ bool run_tests(Z80& cpu, std::string path) {
             }
         }
 
+        const char* mode = (predecoded) ? " predecoded" : "";
+
         if(ok) {
-            std::clog << "\t" << test["name"] << " PASSED\n\n";
+            std::clog << "\t" << test["name"] << mode << " PASSED\n\n";
         }else {
-            std::clog << "\t" << test["name"] << " FAILED\n\n";
+            std::clog << "\t" << test["name"] << mode << " FAILED\n\n";
         }
     }
+
+    cpu.fetchPage = NULL;
+    cpu.decodeBase = NULL;
+    cpu.decodeCache.reset();
     return true;
 }
 
+// An interrupt held on the line through EI HALT is taken once, returning past the HALT into the handler of the mode
+bool run_interrupt_test(Z80& cpu, std::string name, uint8_t mode, uint16_t handler) {
+    std::memset(memory, 0, 64*1024);
+    memory[0x0100] = 0xFB; // EI
+    memory[0x0101] = 0x76; // HALT
+
+    // Mode 2 reads the handler from the table at I, the bus floats the low byte high
+    memory[0x20FF] = handler & 0xFF;
+    memory[0x2100] = handler >> 8;
+
+    cpu.programCounter = 0x0100;
+    cpu.stackPointer = 0xF000;
+    cpu.interruptMode = mode;
+    cpu.interruptVector = 0x20;
+    cpu.IFF1 = 0;
+    cpu.IFF2 = 0;
+    cpu.haltState = Z80::HALT_NONE;
+    cpu.eiState = Z80::EI_NONE;
+    cpu.loopBranch = -1;
+    cpu.intLine = true;
+
+    // The machine delivers after every step while the raised line is due
+    for(int i = 0; i < 8 && cpu.programCounter != handler; i ++) {
+
+        if(!cpu.cycle())
+            break;
+
+        cpu.signalINT();
+    }
+    cpu.intLine = false;
+
+    bool ok = true;
+
+    if(cpu.programCounter != handler) {
+        std::clog << "\t- Mismatch programCounter RESULT: " << (int)cpu.programCounter << ", ACTUAL: " << (int)handler << "\n";
+        ok = false;
+    }
+
+    uint16_t pushed = memory[0xEFFE] | (memory[0xEFFF] << 8);
+
+    if(cpu.stackPointer != 0xEFFE || pushed != 0x0102) {
+        std::clog << "\t- Mismatch return address RESULT: " << (int)pushed << " at " << (int)cpu.stackPointer << ", ACTUAL: " << 0x0102 << " at " << 0xEFFE << "\n";
+        ok = false;
+    }
+
+    if(cpu.haltState != Z80::HALT_NONE || cpu.IFF1 != 0) {
+        std::clog << "\t- Mismatch haltState " << (int)cpu.haltState << " IFF1 " << (int)cpu.IFF1 << "\n";
+        ok = false;
+    }
+
+    std::clog << "\t" << name << " " << (ok ? "PASSED" : "FAILED") << "\n\n";
+    return ok;
+}
+
+bool run_interrupt_tests(Z80& cpu) {
+    bool ok = true;
+
+    ok &= run_interrupt_test(cpu, "EI HALT with a pending interrupt", 1, 0x0038);
+    ok &= run_interrupt_test(cpu, "EI HALT with a pending mode 2 interrupt", 2, 0x3000);
+
+    return ok;
+}
+
 int main(int argc, char* argv[]) {
 
     // Redirect the log to a file
     std::fstream log ("log.txt", std::fstream::out | std::fstream::trunc);
-    std::clog.rdbuf(log.rdbuf());
+    std::streambuf* console = std::clog.rdbuf(log.rdbuf());
 
     // Create the emulator and allocate 64kb for tests
     Z80 cpu;
@@ -246,13 +336,22 @@ int main(int argc, char* argv[]) {
     cpu.port_read = mapper_read;
     cpu.port_write = mapper_write;
     
+    for(int i = 0; i < 64; i ++)
+        pages[i] = memory + i * 1024;
+
+    // Every test again through the predecode cache, and the compiled blocks when built with Z80_JIT
     for(auto& entry : std::filesystem::directory_iterator("tests")) {
-        run_tests(cpu, entry.path().string());
+        run_tests(cpu, entry.path().string(), false);
+        run_tests(cpu, entry.path().string(), true);
     }
     
-    //run_tests(cpu, "tests/ED BB.json");
+    //run_tests(cpu, "tests/ED BB.json", false);
+
+    bool ok = run_interrupt_tests(cpu);
 
+    // The log goes away before std::clog does
+    std::clog.rdbuf(console);
     log.close();
 
-    return 0;
+    return (ok) ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "wav.h"
+
+static const size_t blockSize = 64 * 1024;
+
+static void writeLE(std::fstream& file, uint32_t value, int bytes) {
+    for(int i = 0; i < bytes; i ++)
+        file.put((char)(value >> (i * 8)));
+}
+
+WavWriter::WavWriter() {
+    dataSize = 0;
+    channels = 0;
+    frequency = 0;
+    fillBuffer = 0;
+    pending = false;
+    running = false;
+}
+
+WavWriter::~WavWriter() {
+    close();
+}
+
+bool WavWriter::open(std::string path, int channels, int frequency) {
+    close();
+
+    file.open(path, std::fstream::binary | std::fstream::out | std::fstream::trunc);
+
+    if(!file.good()) {
+        file.close();
+        return false;
+    }
+    this->channels = channels;
+    this->frequency = frequency;
+    dataSize = 0;
+
+    // Sizes are patched once the capture is closed
+    writeHeader();
+
+    buffers[0].reserve(blockSize * 2);
+    buffers[1].reserve(blockSize * 2);
+    fillBuffer = 0;
+    pending = false;
+    running = true;
+
+    thread = std::thread(&WavWriter::writerThread, this);
+    return true;
+}
+
+void WavWriter::write(const int16_t* samples, int count) {
+
+    if(!running)
+        return;
+
+    std::vector<int16_t>& block = buffers[fillBuffer];
+    block.insert(block.end(), samples, samples + count);
+
+    if(block.size() < blockSize)
+        return;
+
+    // Hand the block over only if the writer is idle, otherwise keep filling
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+
+    if(lock.owns_lock() && !pending) {
+        pending = true;
+        fillBuffer ^= 1;
+        signal.notify_one();
+    }
+}
+
+void WavWriter::close() {
+
+    if(!running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    signal.notify_one();
+    thread.join();
+
+    // Drain whatever the emulation was still filling
+    writeBlock(buffers[fillBuffer]);
+
+    file.seekp(4);
+    writeLE(file, 36 + dataSize, 4);
+    file.seekp(40);
+    writeLE(file, dataSize, 4);
+    file.close();
+}
+
+void WavWriter::writeHeader() {
+    file.write("RIFF", 4);
+    writeLE(file, 36, 4);
+    file.write("WAVE", 4);
+
+    // PCM format chunk, 16 bits per sample
+    file.write("fmt ", 4);
+    writeLE(file, 16, 4);
+    writeLE(file, 1, 2);
+    writeLE(file, channels, 2);
+    writeLE(file, frequency, 4);
+    writeLE(file, frequency * channels * sizeof(int16_t), 4);
+    writeLE(file, channels * sizeof(int16_t), 2);
+    writeLE(file, 16, 2);
+
+    file.write("data", 4);
+    writeLE(file, 0, 4);
+}
+
+void WavWriter::writeBlock(std::vector<int16_t>& block) {
+    file.write((const char*)block.data(), block.size() * sizeof(int16_t));
+    dataSize += block.size() * sizeof(int16_t);
+    block.clear();
+}
+
+void WavWriter::writerThread() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while(true) {
+        signal.wait(lock, [this] { return pending || !running; });
+
+        if(pending) {
+            std::vector<int16_t>& block = buffers[fillBuffer ^ 1];
+
+            // Disk I/O happens outside of the lock
+            lock.unlock();
+            writeBlock(block);
+            lock.lock();
+
+            pending = false;
+
+        }else if(!running) {
+            break;
+        }
+    }
+}
\ No newline at end of file
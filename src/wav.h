@@ -0,0 +1,42 @@
+#ifndef WAV_WRITER_H
+#define WAV_WRITER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+struct WavWriter {
+
+    WavWriter();
+    ~WavWriter();
+
+    bool open(std::string path, int channels, int frequency);
+    void write(const int16_t* samples, int count);
+    void close();
+
+private:
+    std::fstream file;
+    uint32_t dataSize;
+    int channels;
+    int frequency;
+
+    /* Double buffered blocks, emulation fills one while the writer thread drains the other */
+    std::vector<int16_t> buffers[2];
+    int fillBuffer;
+    bool pending;
+    bool running;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable signal;
+
+    void writeHeader();
+    void writeBlock(std::vector<int16_t>& block);
+    void writerThread();
+};
+
+#endif
\ No newline at end of file
@@ -2,14 +2,7 @@
 #include "utilities.h"
 #include <iostream>
 
-int Z80::process16BitArithmeticGroup() {
-
-    uint8_t byte[4] {
-        mapper_read(programCounter),
-        mapper_read(programCounter+1),
-        mapper_read(programCounter+2),
-        mapper_read(programCounter+3)
-    };
+int Z80::process16BitArithmeticGroup(const uint8_t* byte) {
 
     switch(byte[0]) {
 
@@ -21,12 +14,11 @@ int Z80::process16BitArithmeticGroup() {
         {
             incrementPC(1);
             uint8_t ss = (byte[0] & 0b00110000) >> 4;
-            uint16_t a = pairBytes(reg[H], reg[L]);
+            uint16_t a = pair[HL];
             uint16_t b = read_ssSymbol(ss);
             ADD16(a, b);
-            reg[H] = a >> 8;
-            reg[L] = a; 
-            std::clog << "ADD HL, " << name_ssSymbol(ss) << "\n";
+            pair[HL] = a;
+            Z80_LOG << "ADD HL, " << name_ssSymbol(ss) << "\n";
             return 11;
         }
 
@@ -42,7 +34,7 @@ int Z80::process16BitArithmeticGroup() {
             uint16_t a = read_ssSymbol(ss);
             INC16(a);
             write_ssSymbol(ss, a);
-            std::clog << "INC " << name_ssSymbol(ss) << "\n";
+            Z80_LOG << "INC " << name_ssSymbol(ss) << "\n";
             return 6;
         }
 
@@ -58,7 +50,7 @@ int Z80::process16BitArithmeticGroup() {
             uint16_t a = read_ssSymbol(ss);
             DEC16(a);
             write_ssSymbol(ss, a);
-            std::clog << "DEC " << name_ssSymbol(ss) << "\n";
+            Z80_LOG << "DEC " << name_ssSymbol(ss) << "\n";
             return 6;
         }
 
@@ -80,12 +72,11 @@ int Z80::process16BitArithmeticGroup() {
                 {
                     incrementPC(2);
                     uint8_t ss = (byte[1] & 0b00110000) >> 4;
-                    uint16_t a = pairBytes(reg[H], reg[L]);
+                    uint16_t a = pair[HL];
                     uint16_t b = read_ssSymbol(ss);
                     ADC16(a, b);
-                    reg[H] = a >> 8;
-                    reg[L] = a; 
-                    std::clog << "ADC HL, " << name_ssSymbol(ss) << "\n";
+                    pair[HL] = a;
+                    Z80_LOG << "ADC HL, " << name_ssSymbol(ss) << "\n";
                     return 15;
                 }
 
@@ -98,12 +89,11 @@ int Z80::process16BitArithmeticGroup() {
                 {
                     incrementPC(2);
                     uint8_t ss = (byte[1] & 0b00110000) >> 4;
-                    uint16_t a = pairBytes(reg[H], reg[L]);
+                    uint16_t a = pair[HL];
                     uint16_t b = read_ssSymbol(ss);
                     SBC16(a, b);
-                    reg[H] = a >> 8;
-                    reg[L] = a; 
-                    std::clog << "SBC HL, " << name_ssSymbol(ss) << "\n";
+                    pair[HL] = a;
+                    Z80_LOG << "SBC HL, " << name_ssSymbol(ss) << "\n";
                     return 15;
                 }
             }
@@ -136,7 +126,7 @@ int Z80::process16BitArithmeticGroup() {
                     else
                         ADD16(index, read_rrSymbol(pp));
 
-                    std::clog << "ADD IX, " << name_ppSymbol(pp) << "\n";
+                    Z80_LOG << "ADD IX, " << name_ppSymbol(pp) << "\n";
                     return 15;
                 }
 
@@ -149,7 +139,7 @@ int Z80::process16BitArithmeticGroup() {
                 {
                     incrementPC(2);
                     INC16(index);
-                    std::clog << "INC IX\n";
+                    Z80_LOG << "INC IX\n";
                     return 10;
                 }
 
@@ -162,7 +152,7 @@ int Z80::process16BitArithmeticGroup() {
                 {
                     incrementPC(2);
                     DEC16(index);
-                    std::clog << "DEC IX\n";
+                    Z80_LOG << "DEC IX\n";
                     return 10;
                 }
             }
@@ -2,15 +2,8 @@
 #include "utilities.h"
 #include <iostream>
 
-int Z80::process16BitLoadGroup() {
-
-    uint8_t byte[4] {
-        mapper_read(programCounter),
-        mapper_read(programCounter+1),
-        mapper_read(programCounter+2),
-        mapper_read(programCounter+3)
-    };
-    
+int Z80::process16BitLoadGroup(const uint8_t* byte) {
+
     switch(byte[0]) {
 
         /* LD dd, nn
@@ -25,7 +18,7 @@ int Z80::process16BitLoadGroup() {
             uint8_t dd = (byte[0] & 0b00110000) >> 4;
             uint16_t data = pairBytes(byte[2], byte[1]);
             write_ddSymbol(dd, data);
-            std::clog << "LD " << name_ddSymbol(dd) << ", " << std::hex << (int)data << "\n";
+            Z80_LOG << "LD " << name_ddSymbol(dd) << ", " << std::hex << (int)data << "\n";
             return 10;
         }
 
@@ -42,7 +35,7 @@ int Z80::process16BitLoadGroup() {
             uint16_t addr = pairBytes(byte[2], byte[1]);
             reg[H] = mapper_read(addr+1);
             reg[L] = mapper_read(addr);
-            std::clog << "LD HL, (" << std::hex << (int)addr << ")\n";
+            Z80_LOG << "LD HL, (" << std::hex << (int)addr << ")\n";
             return 16;
         }
 
@@ -59,7 +52,7 @@ int Z80::process16BitLoadGroup() {
             uint16_t addr = pairBytes(byte[2], byte[1]);
             mapper_write(addr, reg[L]);
             mapper_write(addr+1, reg[H]);
-            std::clog << "LD (" << std::hex << (int)addr << "), HL\n";
+            Z80_LOG << "LD (" << std::hex << (int)addr << "), HL\n";
             return 16;
         }
 
@@ -71,8 +64,8 @@ int Z80::process16BitLoadGroup() {
         case 0b11111001:
         {
             incrementPC(1);
-            stackPointer = pairBytes(reg[H], reg[L]);
-            std::clog << "LD SP, HL\n";
+            stackPointer = pair[HL];
+            Z80_LOG << "LD SP, HL\n";
             return 6;
         }
 
@@ -87,7 +80,7 @@ int Z80::process16BitLoadGroup() {
             uint8_t qq = (byte[0] & 0b00110000) >> 4;
             uint16_t data = read_qqSymbol(qq);
             PUSH(data);
-            std::clog << "PUSH " << name_qqSymbol(qq) << "\n";
+            Z80_LOG << "PUSH " << name_qqSymbol(qq) << "\n";
             return 11;
         }
 
@@ -103,7 +96,7 @@ int Z80::process16BitLoadGroup() {
             uint16_t data; 
             POP(data);
             write_qqSymbol(qq, data);
-            std::clog << "POP " << name_qqSymbol(qq) << "\n";
+            Z80_LOG << "POP " << name_qqSymbol(qq) << "\n";
             return 10;
         }
 
@@ -130,7 +123,7 @@ int Z80::process16BitLoadGroup() {
                     uint16_t addr = pairBytes(byte[3], byte[2]);
                     uint16_t data = pairBytes(mapper_read(addr+1), mapper_read(addr)); 
                     write_ddSymbol(dd, data);
-                    std::clog << "LD " << name_ddSymbol(dd) << ", (" << std::hex << addr << ")\n";
+                    Z80_LOG << "LD " << name_ddSymbol(dd) << ", (" << std::hex << addr << ")\n";
                     return 20;
                 }
 
@@ -149,7 +142,7 @@ int Z80::process16BitLoadGroup() {
                     uint16_t data = read_ddSymbol(dd); 
                     mapper_write(addr, data);
                     mapper_write(addr+1, data >> 8);
-                    std::clog << "LD (" << std::hex << (int)addr << "), " << name_ddSymbol(dd) << "\n";
+                    Z80_LOG << "LD (" << std::hex << (int)addr << "), " << name_ddSymbol(dd) << "\n";
                     return 20;
                 }
             }
@@ -178,7 +171,7 @@ int Z80::process16BitLoadGroup() {
                 {
                     incrementPC(4);
                     index = pairBytes(byte[3], byte[2]);
-                    std::clog << "LD IX, " << std::hex << (int)index << "\n";
+                    Z80_LOG << "LD IX, " << std::hex << (int)index << "\n";
                     return 14;
                 }
 
@@ -194,7 +187,7 @@ int Z80::process16BitLoadGroup() {
                     uint16_t addr = pairBytes(byte[3], byte[2]);
                     uint16_t data = pairBytes(mapper_read(addr+1), mapper_read(addr));
                     index = data;
-                    std::clog << "LD IX, (" << std::hex << (int)addr << ")\n";
+                    Z80_LOG << "LD IX, (" << std::hex << (int)addr << ")\n";
                     return 20;
                 }
 
@@ -210,7 +203,7 @@ int Z80::process16BitLoadGroup() {
                     uint16_t addr = pairBytes(byte[3], byte[2]);
                     mapper_write(addr, index);
                     mapper_write(addr+1, index >> 8);
-                    std::clog << "LD (" << std::hex << (int)addr << "), IX\n";
+                    Z80_LOG << "LD (" << std::hex << (int)addr << "), IX\n";
                     return 20;
                 }
 
@@ -222,7 +215,7 @@ int Z80::process16BitLoadGroup() {
                 {
                     incrementPC(2);
                     stackPointer = index;
-                    std::clog << "LD SP, IX\n";
+                    Z80_LOG << "LD SP, IX\n";
                     return 10;
                 }
 
@@ -234,7 +227,7 @@ int Z80::process16BitLoadGroup() {
                 {
                     incrementPC(2);
                     PUSH(index);
-                    std::clog << "PUSH IX\n";
+                    Z80_LOG << "PUSH IX\n";
                     return 15;
                 }
 
@@ -247,7 +240,7 @@ int Z80::process16BitLoadGroup() {
                 {
                     incrementPC(2);
                     POP(index);
-                    std::clog << "POP IX\n";
+                    Z80_LOG << "POP IX\n";
                     return 14;
                 }
             }
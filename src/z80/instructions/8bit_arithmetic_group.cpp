@@ -3,14 +3,7 @@
 #include <iostream>
 #include <bitset>
 
-int Z80::process8BitArithmeticGroup() {
-
-    uint8_t byte[4] {
-        mapper_read(programCounter),
-        mapper_read(programCounter+1),
-        mapper_read(programCounter+2),
-        mapper_read(programCounter+3)
-    };
+int Z80::process8BitArithmeticGroup(const uint8_t* byte) {
 
     switch(byte[0]) {
 
@@ -23,7 +16,7 @@ int Z80::process8BitArithmeticGroup() {
             incrementPC(1);
             uint8_t rrr = byte[0] & 0b00000111;
             ADD(reg[A], read_rrrSymbol(rrr));
-            std::clog << "ADD A, " << name_rrrSymbol(rrr) << "\n";
+            Z80_LOG << "ADD A, " << name_rrrSymbol(rrr) << "\n";
             return 4;
         }
 
@@ -37,7 +30,7 @@ int Z80::process8BitArithmeticGroup() {
             incrementPC(1);
             uint8_t rrr = byte[0] & 0b00000111;
             SUB(reg[A], read_rrrSymbol(rrr));
-            std::clog << "SUB A, " << name_rrrSymbol(rrr) << "\n";
+            Z80_LOG << "SUB A, " << name_rrrSymbol(rrr) << "\n";
             return 4;
         }
 
@@ -51,7 +44,7 @@ int Z80::process8BitArithmeticGroup() {
             incrementPC(1);
             uint8_t rrr = byte[0] & 0b00000111;
             AND(reg[A], read_rrrSymbol(rrr));
-            std::clog << "AND A, " << name_rrrSymbol(rrr) << "\n";
+            Z80_LOG << "AND A, " << name_rrrSymbol(rrr) << "\n";
             return 4;
         }
 
@@ -65,7 +58,7 @@ int Z80::process8BitArithmeticGroup() {
             incrementPC(1);
             uint8_t rrr = byte[0] & 0b00000111;
             OR(reg[A], read_rrrSymbol(rrr));
-            std::clog << "OR A, " << name_rrrSymbol(rrr) << "\n";
+            Z80_LOG << "OR A, " << name_rrrSymbol(rrr) << "\n";
             return 4;
         }
 
@@ -79,7 +72,7 @@ int Z80::process8BitArithmeticGroup() {
             incrementPC(1);
             uint8_t rrr = byte[0] & 0b00000111;
             XOR(reg[A], read_rrrSymbol(rrr));
-            std::clog << "XOR A, " << name_rrrSymbol(rrr) << "\n";
+            Z80_LOG << "XOR A, " << name_rrrSymbol(rrr) << "\n";
             return 4;
         }
 
@@ -93,7 +86,7 @@ int Z80::process8BitArithmeticGroup() {
             incrementPC(1);
             uint8_t rrr = byte[0] & 0b00000111;
             CP(reg[A], read_rrrSymbol(rrr));
-            std::clog << "CP A, " << name_rrrSymbol(rrr) << "\n";
+            Z80_LOG << "CP A, " << name_rrrSymbol(rrr) << "\n";
             return 4;
         }
 
@@ -109,7 +102,7 @@ int Z80::process8BitArithmeticGroup() {
             uint8_t data = read_rrrSymbol(rrr);
             INC(data);
             write_rrrSymbol(rrr, data);
-            std::clog << "INC " << name_rrrSymbol(rrr) << "\n";
+            Z80_LOG << "INC " << name_rrrSymbol(rrr) << "\n";
             return 4;
         }
 
@@ -125,7 +118,7 @@ int Z80::process8BitArithmeticGroup() {
             uint8_t data = read_rrrSymbol(rrr);
             DEC(data);
             write_rrrSymbol(rrr, data);
-            std::clog << "DEC " << name_rrrSymbol(rrr) << "\n";
+            Z80_LOG << "DEC " << name_rrrSymbol(rrr) << "\n";
             return 4;
         }
 
@@ -139,7 +132,7 @@ int Z80::process8BitArithmeticGroup() {
         {
             incrementPC(2);
             ADD(reg[A], byte[1]);
-            std::clog << "ADD A, " << std::hex << (int)byte[1] << "\n";
+            Z80_LOG << "ADD A, " << std::hex << (int)byte[1] << "\n";
             return 7;
         }
 
@@ -153,7 +146,7 @@ int Z80::process8BitArithmeticGroup() {
         {
             incrementPC(2);
             SUB(reg[A], byte[1]);
-            std::clog << "SUB A, " << std::hex << (int)byte[1] << "\n";
+            Z80_LOG << "SUB A, " << std::hex << (int)byte[1] << "\n";
             return 7;
         }
 
@@ -167,7 +160,7 @@ int Z80::process8BitArithmeticGroup() {
         {
             incrementPC(2);
             AND(reg[A], byte[1]);
-            std::clog << "AND A, " << std::hex << (int)byte[1] << "\n";
+            Z80_LOG << "AND A, " << std::hex << (int)byte[1] << "\n";
             return 7;
         }
 
@@ -181,7 +174,7 @@ int Z80::process8BitArithmeticGroup() {
         {
             incrementPC(2);
             OR(reg[A], byte[1]);
-            std::clog << "OR A, " << std::hex << (int)byte[1] << "\n";
+            Z80_LOG << "OR A, " << std::hex << (int)byte[1] << "\n";
             return 7;
         }
 
@@ -195,7 +188,7 @@ int Z80::process8BitArithmeticGroup() {
         {
             incrementPC(2);
             XOR(reg[A], byte[1]);
-            std::clog << "OR A, " << std::hex << (int)byte[1] << "\n";
+            Z80_LOG << "OR A, " << std::hex << (int)byte[1] << "\n";
             return 7;
         }
 
@@ -209,7 +202,7 @@ int Z80::process8BitArithmeticGroup() {
         {
             incrementPC(2);
             CP(reg[A], byte[1]);
-            std::clog << "CP A, " << std::hex << (int)byte[1] << "\n";
+            Z80_LOG << "CP A, " << std::hex << (int)byte[1] << "\n";
             return 7;
         }
 
@@ -221,9 +214,9 @@ int Z80::process8BitArithmeticGroup() {
         case 0b10000110:
         {
             incrementPC(1);
-            uint8_t data = mapper_read(pairBytes(reg[H], reg[L]));
+            uint8_t data = mapper_read(pair[HL]);
             ADD(reg[A], data);
-            std::clog << "ADD A, (HL)\n";
+            Z80_LOG << "ADD A, (HL)\n";
             return 7;
         }
 
@@ -235,9 +228,9 @@ int Z80::process8BitArithmeticGroup() {
         case 0b10010110:
         {
             incrementPC(1);
-            uint8_t data = mapper_read(pairBytes(reg[H], reg[L]));
+            uint8_t data = mapper_read(pair[HL]);
             SUB(reg[A], data);
-            std::clog << "SUB A, (HL)\n";
+            Z80_LOG << "SUB A, (HL)\n";
             return 7;
         }
 
@@ -249,9 +242,9 @@ int Z80::process8BitArithmeticGroup() {
         case 0b10100110:
         {
             incrementPC(1);
-            uint8_t data = mapper_read(pairBytes(reg[H], reg[L]));
+            uint8_t data = mapper_read(pair[HL]);
             AND(reg[A], data);
-            std::clog << "AND A, (HL)\n";
+            Z80_LOG << "AND A, (HL)\n";
             return 7;
         }
 
@@ -263,9 +256,9 @@ int Z80::process8BitArithmeticGroup() {
         case 0b10110110:
         {
             incrementPC(1);
-            uint8_t data = mapper_read(pairBytes(reg[H], reg[L]));
+            uint8_t data = mapper_read(pair[HL]);
             OR(reg[A], data);
-            std::clog << "OR A, (HL)\n";
+            Z80_LOG << "OR A, (HL)\n";
             return 7;
         }
 
@@ -277,9 +270,9 @@ int Z80::process8BitArithmeticGroup() {
         case 0b10101110:
         {
             incrementPC(1);
-            uint8_t data = mapper_read(pairBytes(reg[H], reg[L]));
+            uint8_t data = mapper_read(pair[HL]);
             XOR(reg[A], data);
-            std::clog << "XOR A, (HL)\n";
+            Z80_LOG << "XOR A, (HL)\n";
             return 7;
         }
 
@@ -291,9 +284,9 @@ int Z80::process8BitArithmeticGroup() {
         case 0b10111110:
         {
             incrementPC(1);
-            uint8_t data = mapper_read(pairBytes(reg[H], reg[L]));
+            uint8_t data = mapper_read(pair[HL]);
             CP(reg[A], data);
-            std::clog << "CP A, (HL)\n";
+            Z80_LOG << "CP A, (HL)\n";
             return 7;
         }
 
@@ -305,10 +298,10 @@ int Z80::process8BitArithmeticGroup() {
         case 0b00110100:
         {
             incrementPC(1);
-            uint8_t data = mapper_read(pairBytes(reg[H], reg[L]));
+            uint8_t data = mapper_read(pair[HL]);
             INC(data);
-            mapper_write(pairBytes(reg[H], reg[L]), data);
-            std::clog << "INC (HL)\n";
+            mapper_write(pair[HL], data);
+            Z80_LOG << "INC (HL)\n";
             return 11;
         }
 
@@ -320,10 +313,10 @@ int Z80::process8BitArithmeticGroup() {
         case 0b00110101:
         {
             incrementPC(1);
-            uint8_t data = mapper_read(pairBytes(reg[H], reg[L]));
+            uint8_t data = mapper_read(pair[HL]);
             DEC(data);
-            mapper_write(pairBytes(reg[H], reg[L]), data);
-            std::clog << "DEC (HL)\n";
+            mapper_write(pair[HL], data);
+            Z80_LOG << "DEC (HL)\n";
             return 11;
         }
 
@@ -337,7 +330,7 @@ int Z80::process8BitArithmeticGroup() {
             incrementPC(1);
             uint8_t rrr = byte[0] & 0b00000111;
             ADC(reg[A], read_rrrSymbol(rrr));
-            std::clog << "ADC A, " << name_rrrSymbol(rrr) << "\n";
+            Z80_LOG << "ADC A, " << name_rrrSymbol(rrr) << "\n";
             return 4;
         }
 
@@ -351,7 +344,7 @@ int Z80::process8BitArithmeticGroup() {
             incrementPC(1);
             uint8_t rrr = byte[0] & 0b00000111;
             SBC(reg[A], read_rrrSymbol(rrr));
-            std::clog << "SBC A, " << name_rrrSymbol(rrr) << "\n";
+            Z80_LOG << "SBC A, " << name_rrrSymbol(rrr) << "\n";
             return 4;
         }
 
@@ -365,7 +358,7 @@ int Z80::process8BitArithmeticGroup() {
         {
             incrementPC(2);
             ADC(reg[A], byte[1]);
-            std::clog << "ADC A, " << std::hex << (int)byte[1] << "\n";
+            Z80_LOG << "ADC A, " << std::hex << (int)byte[1] << "\n";
             return 7;
         }
 
@@ -379,7 +372,7 @@ int Z80::process8BitArithmeticGroup() {
         {
             incrementPC(2);
             SBC(reg[A], byte[1]);
-            std::clog << "SBC A, " << std::hex << (int)byte[1] << "\n";
+            Z80_LOG << "SBC A, " << std::hex << (int)byte[1] << "\n";
             return 7;
         }
 
@@ -391,9 +384,9 @@ int Z80::process8BitArithmeticGroup() {
         case 0b10001110:
         {
             incrementPC(1);
-            uint16_t addr = pairBytes(reg[H], reg[L]);
+            uint16_t addr = pair[HL];
             ADC(reg[A], mapper_read(addr));
-            std::clog << "ADC A, (HL)\n";
+            Z80_LOG << "ADC A, (HL)\n";
             return 7;
         }
 
@@ -405,9 +398,9 @@ int Z80::process8BitArithmeticGroup() {
         case 0b10011110:
         {
             incrementPC(1);
-            uint16_t addr = pairBytes(reg[H], reg[L]);
+            uint16_t addr = pair[HL];
             SBC(reg[A], mapper_read(addr));
-            std::clog << "SBC A, (HL)\n";
+            Z80_LOG << "SBC A, (HL)\n";
             return 7;
         }
 
@@ -421,6 +414,7 @@ int Z80::process8BitArithmeticGroup() {
         case 0b11011101: case 0b11111101:
         {
             uint16_t& index = (byte[0] == 0b11011101) ? indexRegisterX : indexRegisterY;
+            uint8_t* half = (byte[0] == 0b11011101) ? indexHalfX : indexHalfY;
 
             switch(byte[1]) {
 
@@ -434,7 +428,7 @@ int Z80::process8BitArithmeticGroup() {
                     incrementPC(3);
                     uint16_t addr = index + (int8_t)byte[2];
                     ADD(reg[A], mapper_read(addr));
-                    std::clog << "ADD A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
+                    Z80_LOG << "ADD A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
                     return 19;
                 }
 
@@ -449,7 +443,7 @@ int Z80::process8BitArithmeticGroup() {
                     incrementPC(3);
                     uint16_t addr = index + (int8_t)byte[2];
                     SUB(reg[A], mapper_read(addr));
-                    std::clog << "SUB A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
+                    Z80_LOG << "SUB A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
                     return 19;
                 }
 
@@ -464,7 +458,7 @@ int Z80::process8BitArithmeticGroup() {
                     incrementPC(3);
                     uint16_t addr = index + (int8_t)byte[2];
                     ADC(reg[A], mapper_read(addr));
-                    std::clog << "ADC A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
+                    Z80_LOG << "ADC A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
                     return 19;
                 }
 
@@ -479,7 +473,7 @@ int Z80::process8BitArithmeticGroup() {
                     incrementPC(3);
                     uint16_t addr = index + (int8_t)byte[2];
                     SBC(reg[A], mapper_read(addr));
-                    std::clog << "SBC A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
+                    Z80_LOG << "SBC A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
                     return 19;
                 }
 
@@ -494,7 +488,7 @@ int Z80::process8BitArithmeticGroup() {
                     incrementPC(3);
                     uint16_t addr = index + (int8_t)byte[2];
                     AND(reg[A], mapper_read(addr));
-                    std::clog << "AND A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
+                    Z80_LOG << "AND A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
                     return 19;
                 }
 
@@ -509,7 +503,7 @@ int Z80::process8BitArithmeticGroup() {
                     incrementPC(3);
                     uint16_t addr = index + (int8_t)byte[2];
                     OR(reg[A], mapper_read(addr));
-                    std::clog << "OR A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
+                    Z80_LOG << "OR A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
                     return 19;
                 }
 
@@ -524,7 +518,7 @@ int Z80::process8BitArithmeticGroup() {
                     incrementPC(3);
                     uint16_t addr = index + (int8_t)byte[2];
                     XOR(reg[A], mapper_read(addr));
-                    std::clog << "XOR A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
+                    Z80_LOG << "XOR A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
                     return 19;
                 }
 
@@ -539,7 +533,7 @@ int Z80::process8BitArithmeticGroup() {
                     incrementPC(3);
                     uint16_t addr = index + (int8_t)byte[2];
                     CP(reg[A], mapper_read(addr));
-                    std::clog << "CP A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
+                    Z80_LOG << "CP A, (IX+" << std::hex << (int8_t)byte[2] << ")\n";
                     return 19;
                 }
 
@@ -556,7 +550,7 @@ int Z80::process8BitArithmeticGroup() {
                     uint8_t data = mapper_read(addr);
                     INC(data);
                     mapper_write(addr, data);
-                    std::clog << "INC (IX+" << std::hex << (int8_t)byte[2] << ")\n";
+                    Z80_LOG << "INC (IX+" << std::hex << (int8_t)byte[2] << ")\n";
                     return 23;
                 }
 
@@ -573,7 +567,7 @@ int Z80::process8BitArithmeticGroup() {
                     uint8_t data = mapper_read(addr);
                     DEC(data);
                     mapper_write(addr, data);
-                    std::clog << "INC (IX+" << std::hex << (int8_t)byte[2] << ")\n";
+                    Z80_LOG << "INC (IX+" << std::hex << (int8_t)byte[2] << ")\n";
                     return 23;
                 }
 
@@ -586,16 +580,9 @@ int Z80::process8BitArithmeticGroup() {
                 {
                     incrementPC(2);
 
-                    uint8_t data = index;
-                    if(byte[1] & 0b00001000)    data = index;
-                    else                        data = index >> 8; 
-
-                    INC(data);
-
-                    if(byte[1] & 0b00001000)    {index &= 0xFF00; index |= data; }
-                    else                        {index &= 0x00FF; index |= data << 8; }
+                    INC(half[(byte[1] & 0b00001000) ? Low : High]);
 
-                    std::clog << "INC IXh\n";
+                    Z80_LOG << "INC IXh\n";
                     return 10;
                 }
 
@@ -608,16 +595,9 @@ int Z80::process8BitArithmeticGroup() {
                 {
                     incrementPC(2);
 
-                    uint8_t data = index;
-                    if(byte[1] & 0b00001000)    data = index;
-                    else                        data = index >> 8; 
-
-                    DEC(data);
-
-                    if(byte[1] & 0b00001000)    {index &= 0xFF00; index |= data; }
-                    else                        {index &= 0x00FF; index |= data << 8; }
+                    DEC(half[(byte[1] & 0b00001000) ? Low : High]);
 
-                    std::clog << "DEC IXh\n";
+                    Z80_LOG << "DEC IXh\n";
                     return 10;
                 }
 
@@ -630,12 +610,10 @@ int Z80::process8BitArithmeticGroup() {
                 {
                     incrementPC(2);
 
-                    uint8_t data;
-                    if(byte[1] & 0b00000001) data = index;
-                    else                     data = index >> 8;
+                    uint8_t data = half[(byte[1] & 0b00000001) ? Low : High];
 
                     ADD(reg[A], data);
-                    std::clog << "ADD A, IX\n";
+                    Z80_LOG << "ADD A, IX\n";
                     return 10;
                 }
 
@@ -648,12 +626,10 @@ int Z80::process8BitArithmeticGroup() {
                 {
                     incrementPC(2);
 
-                    uint8_t data;
-                    if(byte[1] & 0b00000001) data = index;
-                    else                     data = index >> 8;
+                    uint8_t data = half[(byte[1] & 0b00000001) ? Low : High];
                     
                     ADC(reg[A], data);
-                    std::clog << "ADC A, IX\n";
+                    Z80_LOG << "ADC A, IX\n";
                     return 10;
                 }
 
@@ -666,12 +642,10 @@ int Z80::process8BitArithmeticGroup() {
                 {
                     incrementPC(2);
 
-                    uint8_t data;
-                    if(byte[1] & 0b00000001) data = index;
-                    else                     data = index >> 8;
+                    uint8_t data = half[(byte[1] & 0b00000001) ? Low : High];
                     
                     SUB(reg[A], data);
-                    std::clog << "SUB A, IX\n";
+                    Z80_LOG << "SUB A, IX\n";
                     return 10;
                 }
 
@@ -684,12 +658,10 @@ int Z80::process8BitArithmeticGroup() {
                 {
                     incrementPC(2);
 
-                    uint8_t data;
-                    if(byte[1] & 0b00000001) data = index;
-                    else                     data = index >> 8;
+                    uint8_t data = half[(byte[1] & 0b00000001) ? Low : High];
                     
                     SBC(reg[A], data);
-                    std::clog << "SBC A, IX\n";
+                    Z80_LOG << "SBC A, IX\n";
                     return 10;
                 }
 
@@ -702,12 +674,10 @@ int Z80::process8BitArithmeticGroup() {
                 {
                     incrementPC(2);
 
-                    uint8_t data;
-                    if(byte[1] & 0b00000001) data = index;
-                    else                     data = index >> 8;
+                    uint8_t data = half[(byte[1] & 0b00000001) ? Low : High];
                     
                     AND(reg[A], data);
-                    std::clog << "AND A, IX\n";
+                    Z80_LOG << "AND A, IX\n";
                     return 10;
                 }
 
@@ -720,12 +690,10 @@ int Z80::process8BitArithmeticGroup() {
                 {
                     incrementPC(2);
 
-                    uint8_t data;
-                    if(byte[1] & 0b00000001) data = index;
-                    else                     data = index >> 8;
+                    uint8_t data = half[(byte[1] & 0b00000001) ? Low : High];
                     
                     XOR(reg[A], data);
-                    std::clog << "XOR A, IX\n";
+                    Z80_LOG << "XOR A, IX\n";
                     return 10;
                 }
 
@@ -738,12 +706,10 @@ int Z80::process8BitArithmeticGroup() {
                 {
                     incrementPC(2);
 
-                    uint8_t data;
-                    if(byte[1] & 0b00000001) data = index;
-                    else                     data = index >> 8;
+                    uint8_t data = half[(byte[1] & 0b00000001) ? Low : High];
                     
                     OR(reg[A], data);
-                    std::clog << "OR A, IX\n";
+                    Z80_LOG << "OR A, IX\n";
                     return 10;
                 }
 
@@ -756,12 +722,10 @@ int Z80::process8BitArithmeticGroup() {
                 {
                     incrementPC(2);
 
-                    uint8_t data;
-                    if(byte[1] & 0b00000001) data = index;
-                    else                     data = index >> 8;
+                    uint8_t data = half[(byte[1] & 0b00000001) ? Low : High];
                     
                     CP(reg[A], data);
-                    std::clog << "CP A, IX\n";
+                    Z80_LOG << "CP A, IX\n";
                     return 10;
                 }
             }
@@ -2,15 +2,8 @@
 #include "utilities.h"
 #include <iostream>
 
-int Z80::process8BitLoadGroup() {
-
-    uint8_t byte[4] {
-        mapper_read(programCounter),
-        mapper_read(programCounter+1),
-        mapper_read(programCounter+2),
-        mapper_read(programCounter+3)
-    };
-    
+int Z80::process8BitLoadGroup(const uint8_t* byte) {
+
     switch(byte[0]) {
 
         /* LD r, r'
@@ -29,7 +22,7 @@ int Z80::process8BitLoadGroup() {
             uint8_t rrr = (byte[0] & 0b00111000) >> 3;
             uint8_t rrr_p = byte[0] & 0b00000111;
             write_rrrSymbol(rrr, read_rrrSymbol(rrr_p));
-            std::clog << "LD " << name_rrrSymbol(rrr) <<", " << name_rrrSymbol(rrr_p) << "\n";
+            Z80_LOG << "LD " << name_rrrSymbol(rrr) <<", " << name_rrrSymbol(rrr_p) << "\n";
             return 4;
         }
 
@@ -44,7 +37,7 @@ int Z80::process8BitLoadGroup() {
             incrementPC(2);
             uint8_t rrr = (byte[0] & 0b00111000) >> 3;
             write_rrrSymbol(rrr, byte[1]);
-            std::clog << "LD " << name_rrrSymbol(rrr) <<", " << std::hex << (int)byte[1] << "\n";
+            Z80_LOG << "LD " << name_rrrSymbol(rrr) <<", " << std::hex << (int)byte[1] << "\n";
             return 7;
         }
 
@@ -57,9 +50,9 @@ int Z80::process8BitLoadGroup() {
         {
             incrementPC(1);
             uint8_t rrr = (byte[0] & 0b00111000) >> 3;
-            uint16_t addr = pairBytes(reg[H], reg[L]);
+            uint16_t addr = pair[HL];
             write_rrrSymbol(rrr, mapper_read(addr));
-            std::clog << "LD " << name_rrrSymbol(rrr) << ", (HL) \n";
+            Z80_LOG << "LD " << name_rrrSymbol(rrr) << ", (HL) \n";
             return 7;
         }
 
@@ -72,9 +65,9 @@ int Z80::process8BitLoadGroup() {
         {
             incrementPC(1);
             uint8_t rrr = byte[0] & 0b00000111;
-            uint16_t addr = pairBytes(reg[H], reg[L]);
+            uint16_t addr = pair[HL];
             mapper_write(addr, read_rrrSymbol(rrr));
-            std::clog << "LD (HL), " << name_rrrSymbol(rrr) << " \n";
+            Z80_LOG << "LD (HL), " << name_rrrSymbol(rrr) << " \n";
             return 7;
         }
 
@@ -87,9 +80,9 @@ int Z80::process8BitLoadGroup() {
         case 0b00110110:
         {
             incrementPC(2);
-            uint16_t addr = pairBytes(reg[H], reg[L]);
+            uint16_t addr = pair[HL];
             mapper_write(addr, byte[1]);
-            std::clog << "LD (HL), " << (int)byte[1] << "\n";
+            Z80_LOG << "LD (HL), " << (int)byte[1] << "\n";
             return 10;
         }
 
@@ -101,9 +94,9 @@ int Z80::process8BitLoadGroup() {
         case 0b00001010:
         {
             incrementPC(1);
-            uint16_t addr = pairBytes(reg[B], reg[C]);
+            uint16_t addr = pair[BC];
             reg[A] = mapper_read(addr);
-            std::clog << "LD A, (BC)\n";
+            Z80_LOG << "LD A, (BC)\n";
             return 7;
         }
 
@@ -115,9 +108,9 @@ int Z80::process8BitLoadGroup() {
         case 0b00000010:
         {
             incrementPC(1);
-            uint16_t addr = pairBytes(reg[B], reg[C]);
+            uint16_t addr = pair[BC];
             mapper_write(addr, reg[A]);
-            std::clog << "LD (BC), A\n";
+            Z80_LOG << "LD (BC), A\n";
             return 7;
         }
 
@@ -129,9 +122,9 @@ int Z80::process8BitLoadGroup() {
         case 0b00011010:
         {
             incrementPC(1);
-            uint16_t addr = pairBytes(reg[D], reg[E]);
+            uint16_t addr = pair[DE];
             reg[A] = mapper_read(addr);
-            std::clog << "LD A, (DE)\n";
+            Z80_LOG << "LD A, (DE)\n";
             return 7;
         }
 
@@ -143,9 +136,9 @@ int Z80::process8BitLoadGroup() {
         case 0b00010010:
         {
             incrementPC(1);
-            uint16_t addr = pairBytes(reg[D], reg[E]);
+            uint16_t addr = pair[DE];
             mapper_write(addr, reg[A]);
-            std::clog << "LD (DE), A\n";
+            Z80_LOG << "LD (DE), A\n";
             return 7;
         }
 
@@ -161,7 +154,7 @@ int Z80::process8BitLoadGroup() {
             incrementPC(3);
             uint16_t addr = pairBytes(byte[2], byte[1]);
             reg[A] = mapper_read(addr);
-            std::clog << "LD A, (" << std::hex << (int)addr << ")\n";
+            Z80_LOG << "LD A, (" << std::hex << (int)addr << ")\n";
             return 13;
         }
 
@@ -177,7 +170,7 @@ int Z80::process8BitLoadGroup() {
             incrementPC(3);
             uint16_t addr = pairBytes(byte[2], byte[1]);
             mapper_write(addr, reg[A]);
-            std::clog << "LD (" << std::hex << (int)addr << "), A\n";
+            Z80_LOG << "LD (" << std::hex << (int)addr << "), A\n";
             return 13;
         }
 
@@ -203,7 +196,7 @@ int Z80::process8BitLoadGroup() {
                     setFlag(HalfCarry, 0);
                     setFlag(ParityOverflow, IFF2);
                     setFlag(AddSubtract, 0);
-                    std::clog << "LD A, I\n";
+                    Z80_LOG << "LD A, I\n";
                     return 9;
                 }
 
@@ -216,7 +209,7 @@ int Z80::process8BitLoadGroup() {
                 {
                     incrementPC(2);
                     interruptVector = reg[A];        
-                    std::clog << "LD I, A\n";
+                    Z80_LOG << "LD I, A\n";
                     return 9;
                 }
 
@@ -234,7 +227,7 @@ int Z80::process8BitLoadGroup() {
                     setFlag(HalfCarry, 0);
                     setFlag(ParityOverflow, IFF2);
                     setFlag(AddSubtract, 0);
-                    std::clog << "LD A, R\n";
+                    Z80_LOG << "LD A, R\n";
                     return 9;
                 }
 
@@ -247,7 +240,11 @@ int Z80::process8BitLoadGroup() {
                 {
                     incrementPC(2);
                     memoryRefresh = reg[A];
-                    std::clog << "LD R, A\n";
+
+                    // Passes of a loop no longer count R up the same way
+                    loopSideEffect = true;
+
+                    Z80_LOG << "LD R, A\n";
                     return 9;
                 }
             }
@@ -264,6 +261,7 @@ int Z80::process8BitLoadGroup() {
         case 0b11011101: case 0b11111101:
         {
             uint16_t& index = (byte[0] == 0b11011101) ? indexRegisterX : indexRegisterY;
+            uint8_t* half = (byte[0] == 0b11011101) ? indexHalfX : indexHalfY;
 
             switch(byte[1]) {
 
@@ -278,7 +276,7 @@ int Z80::process8BitLoadGroup() {
                     uint8_t rrr = (byte[1] & 0b00111000) >> 3;
                     uint16_t addr = index + (int8_t)byte[2];
                     write_rrrSymbol(rrr, mapper_read(addr));
-                    std::clog << "LD " << name_rrrSymbol(rrr) << ", (IX+d)\n";
+                    Z80_LOG << "LD " << name_rrrSymbol(rrr) << ", (IX+d)\n";
                     return 19;
                 }
 
@@ -294,7 +292,7 @@ int Z80::process8BitLoadGroup() {
                     uint8_t rrr = byte[1] & 0b00000111;
                     uint16_t addr = index + (int8_t)byte[2];
                     mapper_write(addr, read_rrrSymbol(rrr));
-                    std::clog << "LD (IX+d), " << name_rrrSymbol(rrr) << " \n";
+                    Z80_LOG << "LD (IX+d), " << name_rrrSymbol(rrr) << " \n";
                     return 19;
                 }
 
@@ -310,7 +308,7 @@ int Z80::process8BitLoadGroup() {
                     incrementPC(4);
                     uint16_t addr = index + (int8_t)byte[2];
                     mapper_write(addr, byte[3]);
-                    std::clog << "LD (IX+d), " << std::hex << (int)byte[3] << "\n";
+                    Z80_LOG << "LD (IX+d), " << std::hex << (int)byte[3] << "\n";
                     return 19;
                 }
 
@@ -323,9 +321,8 @@ int Z80::process8BitLoadGroup() {
                 case 0b00101110:
                 {
                     incrementPC(3);
-                    index &= 0xFF00;
-                    index |= byte[2];
-                    std::clog << "LD IXl, n\n";
+                    half[Low] = byte[2];
+                    Z80_LOG << "LD IXl, n\n";
                     return 13;
                 }
 
@@ -338,9 +335,8 @@ int Z80::process8BitLoadGroup() {
                 case 0b00100110:
                 {
                     incrementPC(3);
-                    index &= 0x00FF;
-                    index |= byte[2] << 8;
-                    std::clog << "LD IXh, n\n";
+                    half[High] = byte[2];
+                    Z80_LOG << "LD IXh, n\n";
                     return 13;
                 }
 
@@ -353,7 +349,7 @@ int Z80::process8BitLoadGroup() {
                 {
                     incrementPC(2);
                     uint8_t q = (byte[1] & 0b00111000) >> 3;
-                    uint8_t data = index;
+                    uint8_t data = half[Low];
 
                     switch(q) {
                         case 7: reg[A] = data; break;
@@ -361,10 +357,10 @@ int Z80::process8BitLoadGroup() {
                         case 1: reg[C] = data; break;
                         case 2: reg[D] = data; break;
                         case 3: reg[E] = data; break;
-                        case 4: index &= 0x00FF; index |= data << 8; break;
-                        case 5: index &= 0xFF00; index |= data; break;
+                        case 4: half[High] = data; break;
+                        case 5: half[Low] = data; break;
                     }
-                    std::clog << "LD r, IXl\n";
+                    Z80_LOG << "LD r, IXl\n";
                     return 10;
                 }
 
@@ -377,7 +373,7 @@ int Z80::process8BitLoadGroup() {
                 {
                     incrementPC(2);
                     uint8_t q = (byte[1] & 0b00111000) >> 3;
-                    uint8_t data = index >> 8;
+                    uint8_t data = half[High];
 
                     switch(q) {
                         case 7: reg[A] = data; break;
@@ -385,10 +381,10 @@ int Z80::process8BitLoadGroup() {
                         case 1: reg[C] = data; break;
                         case 2: reg[D] = data; break;
                         case 3: reg[E] = data; break;
-                        case 4: index &= 0x00FF; index |= data << 8; break;
-                        case 5: index &= 0xFF00; index |= data; break;
+                        case 4: half[High] = data; break;
+                        case 5: half[Low] = data; break;
                     }
-                    std::clog << "LD r, IXl\n";
+                    Z80_LOG << "LD r, IXl\n";
                     return 10;
                 }
             }
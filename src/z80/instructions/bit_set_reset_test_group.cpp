@@ -2,14 +2,7 @@
 #include "utilities.h"
 #include <iostream>
 
-int Z80::processBitSetResetTest() {
-
-    uint8_t byte[4] {
-        mapper_read(programCounter),
-        mapper_read(programCounter+1),
-        mapper_read(programCounter+2),
-        mapper_read(programCounter+3)
-    };
+int Z80::processBitSetResetTest(const uint8_t* byte) {
 
     switch(byte[0]) {
 
@@ -38,7 +31,7 @@ int Z80::processBitSetResetTest() {
                     uint8_t rrr = byte[1] & 0b00000111;
                     uint8_t bbb = (byte[1] & 0b00111000) >> 3;
                     BIT(1 << bbb, read_rrrSymbol(rrr));
-                    std::clog << "BIT " << (int)bbb << ", " << name_rrrSymbol(rrr) << "\n";
+                    Z80_LOG << "BIT " << (int)bbb << ", " << name_rrrSymbol(rrr) << "\n";
                     return 8;
                 }
 
@@ -61,7 +54,7 @@ int Z80::processBitSetResetTest() {
                     uint8_t data = read_rrrSymbol(rrr);
                     SET(1 << bbb, data);
                     write_rrrSymbol(rrr, data);
-                    std::clog << "SET " << (int)bbb << ", " << name_rrrSymbol(rrr) << "\n";
+                    Z80_LOG << "SET " << (int)bbb << ", " << name_rrrSymbol(rrr) << "\n";
                     return 8;
                 }
 
@@ -84,7 +77,7 @@ int Z80::processBitSetResetTest() {
                     uint8_t data = read_rrrSymbol(rrr);
                     RES(1 << bbb, data);
                     write_rrrSymbol(rrr, data);
-                    std::clog << "RES " << (int)bbb << ", " << name_rrrSymbol(rrr) << "\n";
+                    Z80_LOG << "RES " << (int)bbb << ", " << name_rrrSymbol(rrr) << "\n";
                     return 8;
                 }
 
@@ -96,10 +89,10 @@ int Z80::processBitSetResetTest() {
                 case 0b01000110: case 0b01001110: case 0b01010110: case 0b01011110: case 0b01100110: case 0b01101110: case 0b01110110: case 0b01111110:
                 {
                     incrementPC(2);
-                    uint16_t addr = pairBytes(reg[H], reg[L]);
+                    uint16_t addr = pair[HL];
                     uint8_t bbb = (byte[1] & 0b00111000) >> 3;
                     BIT(1 << bbb, mapper_read(addr));
-                    std::clog << "BIT " << (int)bbb << ", (HL)\n";
+                    Z80_LOG << "BIT " << (int)bbb << ", (HL)\n";
                     return 12;
                 }
 
@@ -111,12 +104,12 @@ int Z80::processBitSetResetTest() {
                 case 0b11000110: case 0b11001110: case 0b11010110: case 0b11011110: case 0b11100110: case 0b11101110: case 0b11110110: case 0b11111110:
                 {
                     incrementPC(2);
-                    uint16_t addr = pairBytes(reg[H], reg[L]);
+                    uint16_t addr = pair[HL];
                     uint8_t bbb = (byte[1] & 0b00111000) >> 3;
                     uint8_t data = mapper_read(addr);
                     SET(1 << bbb, data);
                     mapper_write(addr, data);
-                    std::clog << "SET " << (int)bbb << ", (HL)\n";
+                    Z80_LOG << "SET " << (int)bbb << ", (HL)\n";
                     return 15;
                 }
 
@@ -128,12 +121,12 @@ int Z80::processBitSetResetTest() {
                 case 0b10000110: case 0b10001110: case 0b10010110: case 0b10011110: case 0b10100110: case 0b10101110: case 0b10110110: case 0b10111110:
                 {
                     incrementPC(2);
-                    uint16_t addr = pairBytes(reg[H], reg[L]);
+                    uint16_t addr = pair[HL];
                     uint8_t bbb = (byte[1] & 0b00111000) >> 3;
                     uint8_t data = mapper_read(addr);
                     RES(1 << bbb, data);
                     mapper_write(addr, data);
-                    std::clog << "RES " << (int)bbb << ", (HL)\n";
+                    Z80_LOG << "RES " << (int)bbb << ", (HL)\n";
                     return 15;
                 }
             }
@@ -168,7 +161,7 @@ int Z80::processBitSetResetTest() {
                         uint16_t addr = index + (int8_t)byte[2];
                         uint8_t bbb = (byte[3] & 0b00111000) >> 3;
                         BIT(1 << bbb, mapper_read(addr));
-                        std::clog << "BIT " << (int)bbb << ", (IX+d)\n";
+                        Z80_LOG << "BIT " << (int)bbb << ", (IX+d)\n";
                         return 20;
                     }
 
@@ -185,7 +178,7 @@ int Z80::processBitSetResetTest() {
                         uint8_t data = mapper_read(addr);
                         SET(1 << bbb, data);
                         mapper_write(addr, data);
-                        std::clog << "SET " << (int)bbb << ", (IX+d)\n";
+                        Z80_LOG << "SET " << (int)bbb << ", (IX+d)\n";
                         return 23;
                     }
 
@@ -202,7 +195,7 @@ int Z80::processBitSetResetTest() {
                         uint8_t data = mapper_read(addr);
                         RES(1 << bbb, data);
                         mapper_write(addr, data);
-                        std::clog << "RES " << (int)bbb << ", (IX+d)\n";
+                        Z80_LOG << "RES " << (int)bbb << ", (IX+d)\n";
                         return 23;
                     }
                 }
@@ -2,14 +2,7 @@
 #include "utilities.h"
 #include <iostream>
 
-int Z80::processCallReturnGroup() {
-
-    uint8_t byte[4] {
-        mapper_read(programCounter),
-        mapper_read(programCounter+1),
-        mapper_read(programCounter+2),
-        mapper_read(programCounter+3)
-    };
+int Z80::processCallReturnGroup(const uint8_t* byte) {
 
     switch(byte[0]) {
 
@@ -24,7 +17,7 @@ int Z80::processCallReturnGroup() {
             incrementPC(3);
             uint16_t addr = pairBytes(byte[2], byte[1]);
             CALL(addr);
-            std::clog << "CALL " << std::hex << (int)addr << "\n";
+            Z80_LOG << "CALL " << std::hex << (int)addr << "\n";
             return 17;
         }
 
@@ -41,7 +34,7 @@ int Z80::processCallReturnGroup() {
             uint16_t addr = pairBytes(byte[2], byte[1]);
             uint8_t ccc = (byte[0] & 0b00111000) >> 3;
 
-            std::clog << "CALL " << name_cccSymbol(ccc) << ", " << std::hex << (int)addr << "\n";
+            Z80_LOG << "CALL " << name_cccSymbol(ccc) << ", " << std::hex << (int)addr << "\n";
 
             if(read_cccSymbol(ccc)) {
                 CALL(addr);
@@ -59,7 +52,7 @@ int Z80::processCallReturnGroup() {
         {
             incrementPC(1);
             RET();
-            std::clog << "RET\n";
+            Z80_LOG << "RET\n";
             return 10;
         }
 
@@ -72,7 +65,7 @@ int Z80::processCallReturnGroup() {
         {
             incrementPC(1);
             uint8_t ccc = (byte[0] & 0b00111000) >> 3;
-            std::clog << "RET " << name_cccSymbol(ccc) << "\n";
+            Z80_LOG << "RET " << name_cccSymbol(ccc) << "\n";
 
             if(read_cccSymbol(ccc)) {
                 RET();
@@ -91,7 +84,7 @@ int Z80::processCallReturnGroup() {
             incrementPC(1);
             uint8_t ttt = (byte[0] & 0b00111000) >> 3;
             RST(ttt);
-            std::clog << "RST " << std::hex << (int)ttt << "\n";
+            Z80_LOG << "RST " << std::hex << (int)ttt << "\n";
             return 11;
         }
 
@@ -113,7 +106,7 @@ int Z80::processCallReturnGroup() {
                 {
                     incrementPC(2);
                     RETI();
-                    std::clog << "RETI\n";
+                    Z80_LOG << "RETI\n";
                     return 14;
                 }
 
@@ -126,7 +119,7 @@ int Z80::processCallReturnGroup() {
                 {
                     incrementPC(2);
                     RETN();
-                    std::clog << "RETN\n";
+                    Z80_LOG << "RETN\n";
                     return 14;
                 }
             }
@@ -3,14 +3,7 @@
 #include <algorithm>
 #include <iostream>
 
-int Z80::processExchangeSearchGroup() {
-
-    uint8_t byte[4] {
-        mapper_read(programCounter),
-        mapper_read(programCounter+1),
-        mapper_read(programCounter+2),
-        mapper_read(programCounter+3)
-    };
+int Z80::processExchangeSearchGroup(const uint8_t* byte) {
 
     switch(byte[0]) {
 
@@ -20,11 +13,10 @@ int Z80::processExchangeSearchGroup() {
         */
         case 0b11101011:
         {
-            std::swap(reg[D], reg[H]);
-            std::swap(reg[E], reg[L]);
+            std::swap(pair[DE], pair[HL]);
             programCounter += 1;
 
-            std::clog << "EX DE, HL\n";
+            Z80_LOG << "EX DE, HL\n";
             return 4;
         }
 
@@ -35,11 +27,11 @@ int Z80::processExchangeSearchGroup() {
         */
         case 0b00001000:
         {
-            std::swap(reg[A], reg[A_p]);
-            std::swap(reg[F], reg[F_p]);
+            flushFlags();
+            std::swap(pair[AF], pair[AF_p]);
             programCounter += 1;
 
-            std::clog << "EX AF, AF'\n";
+            Z80_LOG << "EX AF, AF'\n";
             return 4;
         }
 
@@ -50,15 +42,12 @@ int Z80::processExchangeSearchGroup() {
         */
         case 0b11011001:
         {
-            std::swap(reg[B], reg[B_p]);
-            std::swap(reg[C], reg[C_p]);
-            std::swap(reg[D], reg[D_p]);
-            std::swap(reg[E], reg[E_p]);
-            std::swap(reg[H], reg[H_p]);
-            std::swap(reg[L], reg[L_p]);
+            std::swap(pair[BC], pair[BC_p]);
+            std::swap(pair[DE], pair[DE_p]);
+            std::swap(pair[HL], pair[HL_p]);
             programCounter += 1;
 
-            std::clog << "EXX\n";
+            Z80_LOG << "EXX\n";
             return 4;
         }
 
@@ -80,7 +69,7 @@ int Z80::processExchangeSearchGroup() {
 
             programCounter += 1;
 
-            std::clog << "EX (SP), HL\n";
+            Z80_LOG << "EX (SP), HL\n";
             return 19;
         }
 
@@ -100,8 +89,8 @@ int Z80::processExchangeSearchGroup() {
                 */
                 case 0b11100011:
                 {
-                    uint8_t hi = indexRegisterX >> 8;
-                    uint8_t lo = indexRegisterX;
+                    uint8_t hi = indexHalfX[High];
+                    uint8_t lo = indexHalfX[Low];
         
                     indexRegisterX = pairBytes(mapper_read(stackPointer+1), mapper_read(stackPointer));
         
@@ -110,7 +99,7 @@ int Z80::processExchangeSearchGroup() {
 
                     programCounter += 2;
 
-                    std::clog << "EX (SP), IX\n";
+                    Z80_LOG << "EX (SP), IX\n";
                     return 23;
                 }
             }
@@ -133,8 +122,8 @@ int Z80::processExchangeSearchGroup() {
                 */
                 case 0b11100011:
                 {
-                    uint8_t hi = indexRegisterY >> 8;
-                    uint8_t lo = indexRegisterY;
+                    uint8_t hi = indexHalfY[High];
+                    uint8_t lo = indexHalfY[Low];
         
                     indexRegisterY = pairBytes(mapper_read(stackPointer+1), mapper_read(stackPointer));
         
@@ -143,7 +132,7 @@ int Z80::processExchangeSearchGroup() {
 
                     programCounter += 2;
 
-                    std::clog << "EX (SP), IY\n";
+                    Z80_LOG << "EX (SP), IY\n";
                     return 23;
                 }
             }
@@ -166,26 +155,23 @@ int Z80::processExchangeSearchGroup() {
                 */
                 case 0b10100000:
                 {
-                    mapper_write(pairBytes(reg[D], reg[E]), mapper_read(pairBytes(reg[H], reg[L])));
+                    mapper_write(pair[DE], mapper_read(pair[HL]));
 
-                    uint16_t inc = pairBytes(reg[D], reg[E]) + 1;
-                    reg[D] = inc >> 8;
-                    reg[E] = inc;
+                    uint16_t inc = pair[DE] + 1;
+                    pair[DE] = inc;
 
-                    inc = pairBytes(reg[H], reg[L]) + 1;
-                    reg[H] = inc >> 8;
-                    reg[L] = inc;
+                    inc = pair[HL] + 1;
+                    pair[HL] = inc;
 
-                    inc = pairBytes(reg[B], reg[C]) - 1;
-                    reg[B] = inc >> 8;
-                    reg[C] = inc;
+                    inc = pair[BC] - 1;
+                    pair[BC] = inc;
 
                     setFlag(HalfCarry, 0);
-                    setFlag(ParityOverflow, pairBytes(reg[B], reg[C]) != 0);
+                    setFlag(ParityOverflow, pair[BC] != 0);
                     setFlag(AddSubtract, 0);
 
                     programCounter += 2;
-                    std::clog << "LDI\n";
+                    Z80_LOG << "LDI\n";
                     return 16;
                 }
 
@@ -196,27 +182,32 @@ int Z80::processExchangeSearchGroup() {
                 */
                 case 0b10110000:
                 {
-                    mapper_write(pairBytes(reg[D], reg[E]), mapper_read(pairBytes(reg[H], reg[L])));
+                    // Repeats due before the next event are copied at once
+                    int bulk = bulkCopy(1);
+
+                    if(bulk > 0) {
+                        Z80_LOG << "LDIR\n";
+                        return bulk;
+                    }
 
-                    uint16_t inc = pairBytes(reg[D], reg[E]) + 1;
-                    reg[D] = inc >> 8;
-                    reg[E] = inc;
+                    mapper_write(pair[DE], mapper_read(pair[HL]));
 
-                    inc = pairBytes(reg[H], reg[L]) + 1;
-                    reg[H] = inc >> 8;
-                    reg[L] = inc;
+                    uint16_t inc = pair[DE] + 1;
+                    pair[DE] = inc;
 
-                    inc = pairBytes(reg[B], reg[C]) - 1;
-                    reg[B] = inc >> 8;
-                    reg[C] = inc;
+                    inc = pair[HL] + 1;
+                    pair[HL] = inc;
+
+                    inc = pair[BC] - 1;
+                    pair[BC] = inc;
 
                     setFlag(HalfCarry, 0);
-                    setFlag(ParityOverflow, pairBytes(reg[B], reg[C]) != 0);
+                    setFlag(ParityOverflow, pair[BC] != 0);
                     setFlag(AddSubtract, 0);
 
-                    std::clog << "LDIR\n";
+                    Z80_LOG << "LDIR\n";
 
-                    if(pairBytes(reg[B], reg[C]) == 0) {
+                    if(pair[BC] == 0) {
                         programCounter += 2;
                         return 16;
 
@@ -232,27 +223,24 @@ int Z80::processExchangeSearchGroup() {
                 */
                 case 0b10101000:
                 {
-                    mapper_write(pairBytes(reg[D], reg[E]), mapper_read(pairBytes(reg[H], reg[L])));
+                    mapper_write(pair[DE], mapper_read(pair[HL]));
 
-                    uint16_t inc = pairBytes(reg[D], reg[E]) - 1;
-                    reg[D] = inc >> 8;
-                    reg[E] = inc;
+                    uint16_t inc = pair[DE] - 1;
+                    pair[DE] = inc;
 
-                    inc = pairBytes(reg[H], reg[L]) - 1;
-                    reg[H] = inc >> 8;
-                    reg[L] = inc;
+                    inc = pair[HL] - 1;
+                    pair[HL] = inc;
 
-                    inc = pairBytes(reg[B], reg[C]) - 1;
-                    reg[B] = inc >> 8;
-                    reg[C] = inc;
+                    inc = pair[BC] - 1;
+                    pair[BC] = inc;
 
                     setFlag(HalfCarry, 0);
-                    setFlag(ParityOverflow, pairBytes(reg[B], reg[C]) != 0);
+                    setFlag(ParityOverflow, pair[BC] != 0);
                     setFlag(AddSubtract, 0);
 
                     programCounter += 2;
 
-                    std::clog << "LDD\n";
+                    Z80_LOG << "LDD\n";
                     return 16;
                 }
 
@@ -263,27 +251,32 @@ int Z80::processExchangeSearchGroup() {
                 */
                 case 0b10111000:
                 {
-                    mapper_write(pairBytes(reg[D], reg[E]), mapper_read(pairBytes(reg[H], reg[L])));
+                    // Repeats due before the next event are copied at once
+                    int bulk = bulkCopy(-1);
+
+                    if(bulk > 0) {
+                        Z80_LOG << "LDDR\n";
+                        return bulk;
+                    }
 
-                    uint16_t inc = pairBytes(reg[D], reg[E]) - 1;
-                    reg[D] = inc >> 8;
-                    reg[E] = inc;
+                    mapper_write(pair[DE], mapper_read(pair[HL]));
 
-                    inc = pairBytes(reg[H], reg[L]) - 1;
-                    reg[H] = inc >> 8;
-                    reg[L] = inc;
+                    uint16_t inc = pair[DE] - 1;
+                    pair[DE] = inc;
 
-                    inc = pairBytes(reg[B], reg[C]) - 1;
-                    reg[B] = inc >> 8;
-                    reg[C] = inc;
+                    inc = pair[HL] - 1;
+                    pair[HL] = inc;
+
+                    inc = pair[BC] - 1;
+                    pair[BC] = inc;
 
                     setFlag(HalfCarry, 0);
-                    setFlag(ParityOverflow, pairBytes(reg[B], reg[C]) != 0);
+                    setFlag(ParityOverflow, pair[BC] != 0);
                     setFlag(AddSubtract, 0);
 
-                    std::clog << "LDDR\n";
+                    Z80_LOG << "LDDR\n";
 
-                    if(pairBytes(reg[B], reg[C]) == 0) {
+                    if(pair[BC] == 0) {
                         programCounter += 2;
                         return 16;
 
@@ -300,26 +293,24 @@ int Z80::processExchangeSearchGroup() {
                 case 0b10100001:
                 {
                     uint8_t a = reg[A];
-                    uint8_t b = mapper_read(pairBytes(reg[H], reg[L]));
+                    uint8_t b = mapper_read(pair[HL]);
                     uint8_t comp = a - b;
                     
-                    uint16_t inc = pairBytes(reg[H], reg[L]) + 1;
-                    reg[H] = inc >> 8;
-                    reg[L] = inc;
+                    uint16_t inc = pair[HL] + 1;
+                    pair[HL] = inc;
 
-                    inc = pairBytes(reg[B], reg[C]) - 1;
-                    reg[B] = inc >> 8;
-                    reg[C] = inc;
+                    inc = pair[BC] - 1;
+                    pair[BC] = inc;
                     
                     setFlag(Sign, comp & 0b10000000);
                     setFlag(Zero, comp == 0);
                     setFlag(HalfCarry, halfBorrow8(a, b));
-                    setFlag(ParityOverflow, pairBytes(reg[B], reg[C]) != 0);
+                    setFlag(ParityOverflow, pair[BC] != 0);
                     setFlag(AddSubtract, 1);
 
                     programCounter += 2;
 
-                    std::clog << "CPI\n";
+                    Z80_LOG << "CPI\n";
                     return 16;
                 }
 
@@ -331,26 +322,24 @@ int Z80::processExchangeSearchGroup() {
                 case 0b10110001:
                 {
                     uint8_t a = reg[A];
-                    uint8_t b = mapper_read(pairBytes(reg[H], reg[L]));
+                    uint8_t b = mapper_read(pair[HL]);
                     uint8_t comp = a - b;
                     
-                    uint16_t inc = pairBytes(reg[H], reg[L]) + 1;
-                    reg[H] = inc >> 8;
-                    reg[L] = inc;
+                    uint16_t inc = pair[HL] + 1;
+                    pair[HL] = inc;
 
-                    inc = pairBytes(reg[B], reg[C]) - 1;
-                    reg[B] = inc >> 8;
-                    reg[C] = inc;
+                    inc = pair[BC] - 1;
+                    pair[BC] = inc;
 
                     setFlag(Sign, comp & 0b10000000);
                     setFlag(Zero, comp == 0);
                     setFlag(HalfCarry, halfBorrow8(a, b));
-                    setFlag(ParityOverflow, pairBytes(reg[B], reg[C]) != 0);
+                    setFlag(ParityOverflow, pair[BC] != 0);
                     setFlag(AddSubtract, 1);
 
-                    std::clog << "CPIR\n";
+                    Z80_LOG << "CPIR\n";
 
-                    if(pairBytes(reg[B], reg[C]) == 0 || comp == 0) {
+                    if(pair[BC] == 0 || comp == 0) {
                         programCounter += 2;
                         return 16;
 
@@ -367,26 +356,24 @@ int Z80::processExchangeSearchGroup() {
                 case 0b10101001:
                 {
                     uint8_t a = reg[A];
-                    uint8_t b = mapper_read(pairBytes(reg[H], reg[L]));
+                    uint8_t b = mapper_read(pair[HL]);
                     uint8_t comp = a - b;
                     
-                    uint16_t inc = pairBytes(reg[H], reg[L]) - 1;
-                    reg[H] = inc >> 8;
-                    reg[L] = inc;
+                    uint16_t inc = pair[HL] - 1;
+                    pair[HL] = inc;
 
-                    inc = pairBytes(reg[B], reg[C]) - 1;
-                    reg[B] = inc >> 8;
-                    reg[C] = inc;
+                    inc = pair[BC] - 1;
+                    pair[BC] = inc;
                     
                     setFlag(Sign, comp & 0b10000000);
                     setFlag(Zero, comp == 0);
                     setFlag(HalfCarry, halfBorrow8(a, b));
-                    setFlag(ParityOverflow, pairBytes(reg[B], reg[C]) != 0);
+                    setFlag(ParityOverflow, pair[BC] != 0);
                     setFlag(AddSubtract, 1);
 
                     programCounter += 2;
 
-                    std::clog << "CPD\n";
+                    Z80_LOG << "CPD\n";
                     return 16;
                 }
 
@@ -398,26 +385,24 @@ int Z80::processExchangeSearchGroup() {
                 case 0b10111001:
                 {
                     uint8_t a = reg[A];
-                    uint8_t b = mapper_read(pairBytes(reg[H], reg[L]));
+                    uint8_t b = mapper_read(pair[HL]);
                     uint8_t comp = a - b;
                     
-                    uint16_t inc = pairBytes(reg[H], reg[L]) - 1;
-                    reg[H] = inc >> 8;
-                    reg[L] = inc;
+                    uint16_t inc = pair[HL] - 1;
+                    pair[HL] = inc;
 
-                    inc = pairBytes(reg[B], reg[C]) - 1;
-                    reg[B] = inc >> 8;
-                    reg[C] = inc;
+                    inc = pair[BC] - 1;
+                    pair[BC] = inc;
 
                     setFlag(Sign, comp & 0b10000000);
                     setFlag(Zero, comp == 0);
                     setFlag(HalfCarry, halfBorrow8(a, b));
-                    setFlag(ParityOverflow, pairBytes(reg[B], reg[C]) != 0);
+                    setFlag(ParityOverflow, pair[BC] != 0);
                     setFlag(AddSubtract, 1);
 
-                    std::clog << "CPDR\n";
+                    Z80_LOG << "CPDR\n";
 
-                    if(pairBytes(reg[B], reg[C]) == 0 || comp == 0) {
+                    if(pair[BC] == 0 || comp == 0) {
                         programCounter += 2;
                         return 16;
 
@@ -430,4 +415,52 @@ int Z80::processExchangeSearchGroup() {
         }
     }
     return 0;
+}
+
+int Z80::bulkCopy(int step) {
+
+    if(!event_cycles || !mapper_copy_block)
+        return 0;
+
+    // Repeats left, a BC of 0 runs 65536 times
+    int count = pair[BC];
+
+    if(count == 0)
+        count = 65536;
+
+    // Every repeat but the last has to start before the event
+    int budget = event_cycles();
+
+    if(budget <= 21)
+        return 0;
+
+    int bulk = std::min(count, (budget - 1) / 21 + 1);
+
+    bulk = mapper_copy_block(pair[DE], pair[HL], step, bulk);
+
+    if(bulk <= 0)
+        return 0;
+
+    uint16_t inc = pair[DE] + step * bulk;
+    pair[DE] = inc;
+
+    inc = pair[HL] + step * bulk;
+    pair[HL] = inc;
+
+    inc = pair[BC] - bulk;
+    pair[BC] = inc;
+
+    setFlag(HalfCarry, 0);
+    setFlag(ParityOverflow, pair[BC] != 0);
+    setFlag(AddSubtract, 0);
+
+    // Each 21 cycle repeat is odd, the final 16 cycle one is not
+    if(pair[BC] == 0) {
+        programCounter += 2;
+        oddInstructions = bulk - 1;
+        return 21 * (bulk - 1) + 16;
+    }
+
+    oddInstructions = bulk;
+    return 21 * bulk;
 }
\ No newline at end of file
@@ -3,14 +3,7 @@
 #include <bitset>
 #include <iostream>
 
-int Z80::processGeneralArithmeticGroup() {
-
-    uint8_t byte[4] {
-        mapper_read(programCounter),
-        mapper_read(programCounter+1),
-        mapper_read(programCounter+2),
-        mapper_read(programCounter+3)
-    };
+int Z80::processGeneralArithmeticGroup(const uint8_t* byte) {
 
     switch(byte[0]) {
 
@@ -54,7 +47,7 @@ int Z80::processGeneralArithmeticGroup() {
             setFlag(Zero, reg[A] == 0);
             setFlag(ParityOverflow, std::bitset<8>(reg[A]).count() % 2 == 0);
 
-            std::clog << "DAA\n";
+            Z80_LOG << "DAA\n";
             return 4;
         }
 
@@ -69,7 +62,7 @@ int Z80::processGeneralArithmeticGroup() {
             reg[A] = ~reg[A];
             setFlag(HalfCarry, 1);
             setFlag(AddSubtract, 1);
-            std::clog << "CPL\n";
+            Z80_LOG << "CPL\n";
             return 4;
         }
 
@@ -92,7 +85,7 @@ int Z80::processGeneralArithmeticGroup() {
             }
             setFlag(AddSubtract, 0);
 
-            std::clog << "CCF\n";
+            Z80_LOG << "CCF\n";
             return 4;
         }
 
@@ -107,7 +100,7 @@ int Z80::processGeneralArithmeticGroup() {
             setFlag(HalfCarry, 0);
             setFlag(AddSubtract, 0);
             setFlag(Carry, 1);
-            std::clog << "SCF\n";
+            Z80_LOG << "SCF\n";
             return 4;
         }
 
@@ -119,7 +112,7 @@ int Z80::processGeneralArithmeticGroup() {
         case 0b00000000:
         {
             incrementPC(1);
-            std::clog << "NOP\n";
+            Z80_LOG << "NOP\n";
             return 4;
         }
 
@@ -137,6 +130,21 @@ int Z80::processGeneralArithmeticGroup() {
                 case HALT_NONE:
                 {
                     haltState = HALT_WAIT;
+
+                    if(interrupt_changed)
+                        interrupt_changed();
+                    break;
+                }
+
+                // Nothing changes until an interrupt, so wait out the cycles before the next event at once
+                case HALT_WAIT:
+                {
+                    int budget = (event_cycles) ? event_cycles() : 0;
+
+                    if(budget > 4) {
+                        Z80_LOG << "HALT\n";
+                        return 4 * ((budget - 1) / 4 + 1);
+                    }
                     break;
                 }
 
@@ -148,7 +156,7 @@ int Z80::processGeneralArithmeticGroup() {
                     break;
                 }
             }
-            std::clog << "HALT\n";
+            Z80_LOG << "HALT\n";
             return 4;
         }
 
@@ -162,7 +170,7 @@ int Z80::processGeneralArithmeticGroup() {
             incrementPC(1);
             IFF1 = 0;
             IFF2 = 0;
-            std::clog << "DI\n";
+            Z80_LOG << "DI\n";
             return 4;
         }
 
@@ -175,7 +183,7 @@ int Z80::processGeneralArithmeticGroup() {
         {
             incrementPC(1);
             eiState = EI_WAIT;
-            std::clog << "EI\n";
+            Z80_LOG << "EI\n";
             return 4;
         }
 
@@ -210,7 +218,7 @@ int Z80::processGeneralArithmeticGroup() {
                     setFlag(HalfCarry, halfCarry8(a, -b));
                     setFlag(Carry, b == 0x0);
 
-                    std::clog << "NEG\n";
+                    Z80_LOG << "NEG\n";
                     return 8;
                 }
 
@@ -222,7 +230,7 @@ int Z80::processGeneralArithmeticGroup() {
                 {
                     incrementPC(2);
                     interruptMode = 0;
-                    std::clog << "IM 0\n";
+                    Z80_LOG << "IM 0\n";
                     return 8;
                 }
 
@@ -235,7 +243,7 @@ int Z80::processGeneralArithmeticGroup() {
                 {
                     incrementPC(2);
                     interruptMode = 1;
-                    std::clog << "IM 1\n";
+                    Z80_LOG << "IM 1\n";
                     return 8;
                 }
 
@@ -248,7 +256,7 @@ int Z80::processGeneralArithmeticGroup() {
                 {
                     incrementPC(2);
                     interruptMode = 2;
-                    std::clog << "IM 2\n";
+                    Z80_LOG << "IM 2\n";
                     return 8;
                 }
             }
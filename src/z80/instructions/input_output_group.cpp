@@ -2,15 +2,9 @@
 #include "utilities.h"
 #include <bitset>
 #include <iostream>
+#include <algorithm>
 
-int Z80::processInputOutputGroup() {
-
-    uint8_t byte[4] {
-        mapper_read(programCounter),
-        mapper_read(programCounter+1),
-        mapper_read(programCounter+2),
-        mapper_read(programCounter+3)
-    };
+int Z80::processInputOutputGroup(const uint8_t* byte) {
 
     switch(byte[0]) {
 
@@ -24,7 +18,7 @@ int Z80::processInputOutputGroup() {
             reg[A] = port_read(byte[1]);
             programCounter += 2;
 
-            std::clog << "IN A, (" << std::hex << (int)byte[1] << ")\n";
+            Z80_LOG << "IN A, (" << std::hex << (int)byte[1] << ")\n";
             return 11;
         }
 
@@ -39,7 +33,7 @@ int Z80::processInputOutputGroup() {
             port_write(byte[1], reg[A]);
             programCounter += 2;
 
-            std::clog << "OUT (" << std::hex <<(int)byte[1] << "), A\n";
+            Z80_LOG << "OUT (" << std::hex <<(int)byte[1] << "), A\n";
             return 11;
         }
 
@@ -72,7 +66,7 @@ int Z80::processInputOutputGroup() {
 
                     programCounter += 2;
 
-                    std::clog << "IN " << name_rrrSymbol(rrr) << ", (C)\n";
+                    Z80_LOG << "IN " << name_rrrSymbol(rrr) << ", (C)\n";
                     return 12;
                 }
 
@@ -82,7 +76,7 @@ int Z80::processInputOutputGroup() {
                 */
                 case 0b10100010:
                 {
-                    uint16_t ptr = pairBytes(reg[H], reg[L]);
+                    uint16_t ptr = pair[HL];
 
                     uint8_t data = port_read(reg[C]);
                     mapper_write(ptr, data);
@@ -92,15 +86,14 @@ int Z80::processInputOutputGroup() {
 
                     // Decrement HL
                     ptr = ptr + 1;
-                    reg[H] = ptr >> 8;
-                    reg[L] = ptr;
+                    pair[HL] = ptr;
 
                     setFlag(Zero, reg[B] == 0);
                     setFlag(AddSubtract, 1);
 
                     programCounter += 2;
 
-                    std::clog << "INI\n";
+                    Z80_LOG << "INI\n";
                     return 16;
                 }
 
@@ -111,7 +104,7 @@ int Z80::processInputOutputGroup() {
                 */
                 case 0b10110010:
                 {
-                    uint16_t ptr = pairBytes(reg[H], reg[L]);
+                    uint16_t ptr = pair[HL];
 
                     uint8_t data = port_read(reg[C]);
                     mapper_write(ptr, data);
@@ -121,13 +114,12 @@ int Z80::processInputOutputGroup() {
 
                     // Increment HL
                     ptr = ptr + 1;
-                    reg[H] = ptr >> 8;
-                    reg[L] = ptr;
+                    pair[HL] = ptr;
 
                     setFlag(Zero, 1);
                     setFlag(AddSubtract, 1);
 
-                    std::clog << "INIR\n";
+                    Z80_LOG << "INIR\n";
 
                     if(reg[B] == 0) {
                         programCounter += 2;
@@ -145,7 +137,7 @@ int Z80::processInputOutputGroup() {
                 */
                 case 0b10101010:
                 {
-                    uint16_t ptr = pairBytes(reg[H], reg[L]);
+                    uint16_t ptr = pair[HL];
 
                     uint8_t data = port_read(reg[C]);
                     mapper_write(ptr, data);
@@ -155,15 +147,14 @@ int Z80::processInputOutputGroup() {
 
                     // Decrement HL
                     ptr = ptr - 1;
-                    reg[H] = ptr >> 8;
-                    reg[L] = ptr;
+                    pair[HL] = ptr;
 
                     setFlag(Zero, reg[B] == 0);
                     setFlag(AddSubtract, 1);
 
                     programCounter += 2;
 
-                    std::clog << "IND\n";
+                    Z80_LOG << "IND\n";
                     return 16;
                 }
 
@@ -174,7 +165,7 @@ int Z80::processInputOutputGroup() {
                 */
                 case 0b10111010:
                 {
-                    uint16_t ptr = pairBytes(reg[H], reg[L]);
+                    uint16_t ptr = pair[HL];
 
                     uint8_t data = port_read(reg[C]);
                     mapper_write(ptr, data);
@@ -184,13 +175,12 @@ int Z80::processInputOutputGroup() {
 
                     // Increment HL
                     ptr = ptr - 1;
-                    reg[H] = ptr >> 8;
-                    reg[L] = ptr;
+                    pair[HL] = ptr;
 
                     setFlag(Zero, 1);
                     setFlag(AddSubtract, 1);
 
-                    std::clog << "INDR\n";
+                    Z80_LOG << "INDR\n";
 
                     if(reg[B] == 0) {
                         programCounter += 2;
@@ -215,7 +205,7 @@ int Z80::processInputOutputGroup() {
 
                     programCounter += 2;
 
-                    std::clog << "OUT (C), " << name_rrrSymbol(rrr) << "\n";
+                    Z80_LOG << "OUT (C), " << name_rrrSymbol(rrr) << "\n";
                     return 12;
                 }
 
@@ -226,7 +216,7 @@ int Z80::processInputOutputGroup() {
                 */
                 case 0b10100011:
                 {
-                    uint16_t localPtr = pairBytes(reg[H], reg[L]);
+                    uint16_t localPtr = pair[HL];
 
                     uint8_t data = mapper_read(localPtr);
                     port_write(reg[C], data);
@@ -236,15 +226,14 @@ int Z80::processInputOutputGroup() {
 
                     // Decrement HL
                     localPtr = localPtr + 1;
-                    reg[H] = localPtr >> 8;
-                    reg[L] = localPtr;
+                    pair[HL] = localPtr;
 
                     setFlag(Zero, reg[B] == 0);
                     setFlag(AddSubtract, 1);
 
                     programCounter += 2;
 
-                    std::clog << "OUTI\n";
+                    Z80_LOG << "OUTI\n";
                     return 16;
                 }
 
@@ -255,7 +244,15 @@ int Z80::processInputOutputGroup() {
                 */
                 case 0b10110011:
                 {
-                    uint16_t localPtr = pairBytes(reg[H], reg[L]);
+                    // Repeats due before the next event go out at once
+                    int bulk = bulkOutput(1);
+
+                    if(bulk > 0) {
+                        Z80_LOG << "OTIR\n";
+                        return bulk;
+                    }
+
+                    uint16_t localPtr = pair[HL];
 
                     uint8_t data = mapper_read(localPtr);
                     port_write(reg[C], data);
@@ -265,13 +262,12 @@ int Z80::processInputOutputGroup() {
 
                     // Decrement HL
                     localPtr = localPtr + 1;
-                    reg[H] = localPtr >> 8;
-                    reg[L] = localPtr;
+                    pair[HL] = localPtr;
 
                     setFlag(Zero, 1);
                     setFlag(AddSubtract, 1);
 
-                    std::clog << "OTIR\n";
+                    Z80_LOG << "OTIR\n";
 
                     if(reg[B] == 0) {
                         programCounter += 2;
@@ -289,7 +285,7 @@ int Z80::processInputOutputGroup() {
                 */
                 case 0b10101011:
                 {
-                    uint16_t localPtr = pairBytes(reg[H], reg[L]);
+                    uint16_t localPtr = pair[HL];
 
                     uint8_t data = mapper_read(localPtr);
                     port_write(reg[C], data);
@@ -299,15 +295,14 @@ int Z80::processInputOutputGroup() {
 
                     // Decrement HL
                     localPtr = localPtr - 1;
-                    reg[H] = localPtr >> 8;
-                    reg[L] = localPtr;
+                    pair[HL] = localPtr;
 
                     setFlag(Zero, reg[B] == 0);
                     setFlag(AddSubtract, 1);
 
                     programCounter += 2;
 
-                    std::clog << "OUTD\n";
+                    Z80_LOG << "OUTD\n";
                     return 16;
                 }
 
@@ -318,7 +313,15 @@ int Z80::processInputOutputGroup() {
                 */
                 case 0b10111011:
                 {
-                    uint16_t localPtr = pairBytes(reg[H], reg[L]);
+                    // Repeats due before the next event go out at once
+                    int bulk = bulkOutput(-1);
+
+                    if(bulk > 0) {
+                        Z80_LOG << "OTDR\n";
+                        return bulk;
+                    }
+
+                    uint16_t localPtr = pair[HL];
 
                     uint8_t data = mapper_read(localPtr);
                     port_write(reg[C], data);
@@ -328,13 +331,12 @@ int Z80::processInputOutputGroup() {
 
                     // Decrement HL
                     localPtr = localPtr - 1;
-                    reg[H] = localPtr >> 8;
-                    reg[L] = localPtr;
+                    pair[HL] = localPtr;
 
                     setFlag(Zero, 1);
                     setFlag(AddSubtract, 1);
 
-                    std::clog << "OTDR\n";
+                    Z80_LOG << "OTDR\n";
 
                     if(reg[B] == 0) {
                         programCounter += 2;
@@ -349,4 +351,43 @@ int Z80::processInputOutputGroup() {
         }
     }
     return 0;
+}
+
+int Z80::bulkOutput(int step) {
+
+    if(!event_cycles || !port_write_block)
+        return 0;
+
+    // Repeats left, a B of 0 runs 256 times
+    int count = (reg[B] == 0) ? 256 : reg[B];
+
+    // Every repeat but the last has to start before the event
+    int budget = event_cycles();
+
+    if(budget <= 21)
+        return 0;
+
+    int bulk = std::min(count, (budget - 1) / 21 + 1);
+    uint16_t localPtr = pair[HL];
+
+    if(!port_write_block(reg[C], localPtr, step, bulk))
+        return 0;
+
+    reg[B] = reg[B] - bulk;
+
+    localPtr = localPtr + step * bulk;
+    pair[HL] = localPtr;
+
+    setFlag(Zero, 1);
+    setFlag(AddSubtract, 1);
+
+    // Each 21 cycle repeat is odd, the final 16 cycle one is not
+    if(reg[B] == 0) {
+        programCounter += 2;
+        oddInstructions = bulk - 1;
+        return 21 * (bulk - 1) + 16;
+    }
+
+    oddInstructions = bulk;
+    return 21 * bulk;
 }
\ No newline at end of file
@@ -2,14 +2,7 @@
 #include "utilities.h"
 #include <iostream>
 
-int Z80::processJumpGroup() {
-
-    uint8_t byte[4] {
-        mapper_read(programCounter),
-        mapper_read(programCounter+1),
-        mapper_read(programCounter+2),
-        mapper_read(programCounter+3)
-    };
+int Z80::processJumpGroup(const uint8_t* byte) {
 
     switch(byte[0]) {
 
@@ -25,7 +18,7 @@ int Z80::processJumpGroup() {
             uint16_t addr = pairBytes(byte[2], byte[1]);
             programCounter = addr;
 
-            std::clog << "JP " << std::hex << (int)addr << "\n";
+            Z80_LOG << "JP " << std::hex << (int)addr << "\n";
             return 10;
         }
 
@@ -45,7 +38,7 @@ int Z80::processJumpGroup() {
             if(read_cccSymbol(ccc)) {
                 programCounter = addr;
             }
-            std::clog << "JP " << name_cccSymbol(ccc) << ", " << std::hex << (int)addr << "\n";
+            Z80_LOG << "JP " << name_cccSymbol(ccc) << ", " << std::hex << (int)addr << "\n";
             return 10;
         }
 
@@ -60,7 +53,7 @@ int Z80::processJumpGroup() {
             incrementPC(2);
             int8_t offset = (int8_t)byte[1];
             programCounter += offset;
-            std::clog << "JR " << (int)offset << "\n";
+            Z80_LOG << "JR " << (int)offset << "\n";
             return 12;
         }
 
@@ -75,7 +68,7 @@ int Z80::processJumpGroup() {
             incrementPC(2);
             int8_t offset = (int8_t)byte[1];
 
-            std::clog << "JR C, " << (int)offset << "\n";
+            Z80_LOG << "JR C, " << (int)offset << "\n";
 
             if(getFlag(Carry)) {
                 programCounter += offset;
@@ -95,7 +88,7 @@ int Z80::processJumpGroup() {
             incrementPC(2);
             int8_t offset = (int8_t)byte[1];
 
-            std::clog << "JR NC, " << (int)offset << "\n";
+            Z80_LOG << "JR NC, " << (int)offset << "\n";
 
             if(!getFlag(Carry)) {
                 programCounter += offset;
@@ -115,7 +108,7 @@ int Z80::processJumpGroup() {
             incrementPC(2);
             int8_t offset = (int8_t)byte[1];
 
-            std::clog << "JR Z, " << (int)offset << "\n";
+            Z80_LOG << "JR Z, " << (int)offset << "\n";
 
             if(getFlag(Zero)) {
                 programCounter += offset;
@@ -135,7 +128,7 @@ int Z80::processJumpGroup() {
             incrementPC(2);
             int8_t offset = (int8_t)byte[1];
 
-            std::clog << "JR NZ, " << (int)offset << "\n";
+            Z80_LOG << "JR NZ, " << (int)offset << "\n";
 
             if(!getFlag(Zero)) {
                 programCounter += offset;
@@ -152,9 +145,9 @@ int Z80::processJumpGroup() {
         case 0b11101001:
         {
             incrementPC(1);
-            uint16_t addr = pairBytes(reg[H], reg[L]);
+            uint16_t addr = pair[HL];
             programCounter = addr;
-            std::clog << "JP (HL)\n";
+            Z80_LOG << "JP (HL)\n";
             return 4;
         }
 
@@ -170,7 +163,7 @@ int Z80::processJumpGroup() {
             reg[B] = reg[B] - 1;
             int8_t offset = (int8_t)byte[1];
 
-            std::clog << "DJNZ, " << (int)offset << "\n";
+            Z80_LOG << "DJNZ, " << (int)offset << "\n";
 
             if(reg[B] == 0) {
                 return 8;
@@ -199,7 +192,7 @@ int Z80::processJumpGroup() {
                 {
                     incrementPC(2);
                     programCounter = indexRegisterX;
-                    std::clog << "JP, (IX)\n";
+                    Z80_LOG << "JP, (IX)\n";
                     return 8;
                 }
             }
@@ -224,7 +217,7 @@ int Z80::processJumpGroup() {
                 {
                     incrementPC(2);
                     programCounter = indexRegisterY;
-                    std::clog << "JP, (IY)\n";
+                    Z80_LOG << "JP, (IY)\n";
                     return 8;
                 }
             }
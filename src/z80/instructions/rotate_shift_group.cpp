@@ -3,14 +3,7 @@
 #include <bitset>
 #include <iostream>
 
-int Z80::processRotateShiftGroup() {
-
-    uint8_t byte[4] {
-        mapper_read(programCounter),
-        mapper_read(programCounter+1),
-        mapper_read(programCounter+2),
-        mapper_read(programCounter+3)
-    };
+int Z80::processRotateShiftGroup(const uint8_t* byte) {
 
     switch(byte[0]) {
 
@@ -22,7 +15,7 @@ int Z80::processRotateShiftGroup() {
         {
             incrementPC(1);
             RLC(reg[A], true);
-            std::clog << "RLC A\n";
+            Z80_LOG << "RLC A\n";
             return 4;
         }
 
@@ -35,7 +28,7 @@ int Z80::processRotateShiftGroup() {
         {
             incrementPC(1);
             RL(reg[A], true);
-            std::clog << "RL A\n";
+            Z80_LOG << "RL A\n";
             return 4;
         }
 
@@ -48,7 +41,7 @@ int Z80::processRotateShiftGroup() {
         {
             incrementPC(1);
             RRC(reg[A], true);
-            std::clog << "RRC A\n";
+            Z80_LOG << "RRC A\n";
             return 4;
         }
 
@@ -61,7 +54,7 @@ int Z80::processRotateShiftGroup() {
         {
             incrementPC(1);
             RR(reg[A], true);
-            std::clog << "RR A\n";
+            Z80_LOG << "RR A\n";
             return 4;
         }
 
@@ -82,7 +75,7 @@ int Z80::processRotateShiftGroup() {
                 case 0b01101111:
                 {
                     incrementPC(2);
-                    uint16_t addr = pairBytes(reg[H], reg[L]);
+                    uint16_t addr = pair[HL];
                     uint8_t data = mapper_read(addr);
 
                     uint8_t a = reg[A] & 0b00001111;
@@ -104,7 +97,7 @@ int Z80::processRotateShiftGroup() {
                     setFlag(ParityOverflow, std::bitset<8>(reg[A]).count() % 2 == 0);
                     setFlag(AddSubtract, 0);
 
-                    std::clog << "RLD\n";
+                    Z80_LOG << "RLD\n";
                     return 18;
                 }
 
@@ -116,7 +109,7 @@ int Z80::processRotateShiftGroup() {
                 case 0b01100111:
                 {
                     incrementPC(2);
-                    uint16_t addr = pairBytes(reg[H], reg[L]);
+                    uint16_t addr = pair[HL];
                     uint8_t data = mapper_read(addr);
 
                     uint8_t a = reg[A] & 0b00001111;
@@ -138,7 +131,7 @@ int Z80::processRotateShiftGroup() {
                     setFlag(ParityOverflow, std::bitset<8>(reg[A]).count() % 2 == 0);
                     setFlag(AddSubtract, 0);
 
-                    std::clog << "RRD\n";
+                    Z80_LOG << "RRD\n";
                     return 18;
                 }
             }
@@ -166,7 +159,7 @@ int Z80::processRotateShiftGroup() {
                     uint8_t data = read_rrrSymbol(rrr);
                     RLC(data);
                     write_rrrSymbol(rrr, data);
-                    std::clog << "RLC " << name_rrrSymbol(rrr) << "\n";
+                    Z80_LOG << "RLC " << name_rrrSymbol(rrr) << "\n";
                     return 8;
                 }
 
@@ -182,7 +175,7 @@ int Z80::processRotateShiftGroup() {
                     uint8_t data = read_rrrSymbol(rrr);
                     SLL(data);
                     write_rrrSymbol(rrr, data);
-                    std::clog << "SLL " << name_rrrSymbol(rrr) << "\n";
+                    Z80_LOG << "SLL " << name_rrrSymbol(rrr) << "\n";
                     return 8;
                 }
 
@@ -198,7 +191,7 @@ int Z80::processRotateShiftGroup() {
                     uint8_t data = read_rrrSymbol(rrr);
                     RL(data);
                     write_rrrSymbol(rrr, data);
-                    std::clog << "RL " << name_rrrSymbol(rrr) << "\n";
+                    Z80_LOG << "RL " << name_rrrSymbol(rrr) << "\n";
                     return 8;
                 }
 
@@ -214,7 +207,7 @@ int Z80::processRotateShiftGroup() {
                     uint8_t data = read_rrrSymbol(rrr);
                     RRC(data);
                     write_rrrSymbol(rrr, data);
-                    std::clog << "RRC " << name_rrrSymbol(rrr) << "\n";
+                    Z80_LOG << "RRC " << name_rrrSymbol(rrr) << "\n";
                     return 8;
                 }
 
@@ -230,7 +223,7 @@ int Z80::processRotateShiftGroup() {
                     uint8_t data = read_rrrSymbol(rrr);
                     RR(data);
                     write_rrrSymbol(rrr, data);
-                    std::clog << "RR " << name_rrrSymbol(rrr) << "\n";
+                    Z80_LOG << "RR " << name_rrrSymbol(rrr) << "\n";
                     return 8;
                 }
 
@@ -246,7 +239,7 @@ int Z80::processRotateShiftGroup() {
                     uint8_t data = read_rrrSymbol(rrr);
                     SLA(data);
                     write_rrrSymbol(rrr, data);
-                    std::clog << "SLA " << name_rrrSymbol(rrr) << "\n";
+                    Z80_LOG << "SLA " << name_rrrSymbol(rrr) << "\n";
                     return 8;
                 }
 
@@ -262,7 +255,7 @@ int Z80::processRotateShiftGroup() {
                     uint8_t data = read_rrrSymbol(rrr);
                     SRA(data);
                     write_rrrSymbol(rrr, data);
-                    std::clog << "SRA " << name_rrrSymbol(rrr) << "\n";
+                    Z80_LOG << "SRA " << name_rrrSymbol(rrr) << "\n";
                     return 8;
                 }
 
@@ -278,7 +271,7 @@ int Z80::processRotateShiftGroup() {
                     uint8_t data = read_rrrSymbol(rrr);
                     SRL(data);
                     write_rrrSymbol(rrr, data);
-                    std::clog << "SRL " << name_rrrSymbol(rrr) << "\n";
+                    Z80_LOG << "SRL " << name_rrrSymbol(rrr) << "\n";
                     return 8;
                 }
 
@@ -290,11 +283,11 @@ int Z80::processRotateShiftGroup() {
                 case 0b00000110:
                 {
                     incrementPC(2);
-                    uint16_t addr = pairBytes(reg[H], reg[L]);
+                    uint16_t addr = pair[HL];
                     uint8_t data = mapper_read(addr);
                     RLC(data);
                     mapper_write(addr, data);
-                    std::clog << "RLC (HL)\n";
+                    Z80_LOG << "RLC (HL)\n";
                     return 15;
                 }
 
@@ -306,11 +299,11 @@ int Z80::processRotateShiftGroup() {
                 case 0b00110110: 
                 {
                     incrementPC(2);
-                    uint16_t addr = pairBytes(reg[H], reg[L]);
+                    uint16_t addr = pair[HL];
                     uint8_t data = mapper_read(addr);
                     SLL(data);
                     mapper_write(addr, data);
-                    std::clog << "SLL (HL)\n";
+                    Z80_LOG << "SLL (HL)\n";
                     return 15;
                 }
 
@@ -322,11 +315,11 @@ int Z80::processRotateShiftGroup() {
                 case 0b00010110:
                 {
                     incrementPC(2);
-                    uint16_t addr = pairBytes(reg[H], reg[L]);
+                    uint16_t addr = pair[HL];
                     uint8_t data = mapper_read(addr);
                     RL(data);
                     mapper_write(addr, data);
-                    std::clog << "RL (HL)\n";
+                    Z80_LOG << "RL (HL)\n";
                     return 15;
                 }
 
@@ -338,11 +331,11 @@ int Z80::processRotateShiftGroup() {
                 case 0b00001110:
                 {
                     incrementPC(2);
-                    uint16_t addr = pairBytes(reg[H], reg[L]);
+                    uint16_t addr = pair[HL];
                     uint8_t data = mapper_read(addr);
                     RRC(data);
                     mapper_write(addr, data);
-                    std::clog << "RRC (HL)\n";
+                    Z80_LOG << "RRC (HL)\n";
                     return 15;
                 }
 
@@ -354,11 +347,11 @@ int Z80::processRotateShiftGroup() {
                 case 0b00011110:
                 {
                     incrementPC(2);
-                    uint16_t addr = pairBytes(reg[H], reg[L]);
+                    uint16_t addr = pair[HL];
                     uint8_t data = mapper_read(addr);
                     RR(data);
                     mapper_write(addr, data);
-                    std::clog << "RR (HL)\n";
+                    Z80_LOG << "RR (HL)\n";
                     return 15;
                 }
 
@@ -370,11 +363,11 @@ int Z80::processRotateShiftGroup() {
                 case 0b00100110:
                 {
                     incrementPC(2);
-                    uint16_t addr = pairBytes(reg[H], reg[L]);
+                    uint16_t addr = pair[HL];
                     uint8_t data = mapper_read(addr);
                     SLA(data);
                     mapper_write(addr, data);
-                    std::clog << "SLA (HL)\n";
+                    Z80_LOG << "SLA (HL)\n";
                     return 15;
                 }
 
@@ -386,11 +379,11 @@ int Z80::processRotateShiftGroup() {
                 case 0b00101110:
                 {
                     incrementPC(2);
-                    uint16_t addr = pairBytes(reg[H], reg[L]);
+                    uint16_t addr = pair[HL];
                     uint8_t data = mapper_read(addr);
                     SRA(data);
                     mapper_write(addr, data);
-                    std::clog << "SRA (HL)\n";
+                    Z80_LOG << "SRA (HL)\n";
                     return 15;
                 }
 
@@ -402,11 +395,11 @@ int Z80::processRotateShiftGroup() {
                 case 0b00111110:
                 {
                     incrementPC(2);
-                    uint16_t addr = pairBytes(reg[H], reg[L]);
+                    uint16_t addr = pair[HL];
                     uint8_t data = mapper_read(addr);
                     SRL(data);
                     mapper_write(addr, data);
-                    std::clog << "SRL (HL)\n";
+                    Z80_LOG << "SRL (HL)\n";
                     return 8;
                 }
             }
@@ -439,7 +432,7 @@ int Z80::processRotateShiftGroup() {
                         uint8_t data = mapper_read(addr);
                         RLC(data);
                         mapper_write(addr, data);
-                        std::clog << "RLC (IX+d)\n";
+                        Z80_LOG << "RLC (IX+d)\n";
                         return 23;
                     }
 
@@ -455,7 +448,7 @@ int Z80::processRotateShiftGroup() {
                         uint8_t data = mapper_read(addr);
                         SLL(data);
                         mapper_write(addr, data);
-                        std::clog << "SLL (IX+d)\n";
+                        Z80_LOG << "SLL (IX+d)\n";
                         return 23;
                     }
 
@@ -471,7 +464,7 @@ int Z80::processRotateShiftGroup() {
                         uint8_t data = mapper_read(addr);
                         RL(data);
                         mapper_write(addr, data);
-                        std::clog << "RL (IX+d)\n";
+                        Z80_LOG << "RL (IX+d)\n";
                         return 23;
                     }
 
@@ -487,7 +480,7 @@ int Z80::processRotateShiftGroup() {
                         uint8_t data = mapper_read(addr);
                         RRC(data);
                         mapper_write(addr, data);
-                        std::clog << "RRC (IX+d)\n";
+                        Z80_LOG << "RRC (IX+d)\n";
                         return 23;
                     }
 
@@ -503,7 +496,7 @@ int Z80::processRotateShiftGroup() {
                         uint8_t data = mapper_read(addr);
                         RR(data);
                         mapper_write(addr, data);
-                        std::clog << "RR (IX+d)\n";
+                        Z80_LOG << "RR (IX+d)\n";
                         return 23;
                     }
 
@@ -519,7 +512,7 @@ int Z80::processRotateShiftGroup() {
                         uint8_t data = mapper_read(addr);
                         SLA(data);
                         mapper_write(addr, data);
-                        std::clog << "SLA (IX+d)\n";
+                        Z80_LOG << "SLA (IX+d)\n";
                         return 23;
                     }
 
@@ -535,7 +528,7 @@ int Z80::processRotateShiftGroup() {
                         uint8_t data = mapper_read(addr);
                         SRA(data);
                         mapper_write(addr, data);
-                        std::clog << "SRA (IX+d)\n";
+                        Z80_LOG << "SRA (IX+d)\n";
                         return 23;
                     }
 
@@ -551,7 +544,7 @@ int Z80::processRotateShiftGroup() {
                         uint8_t data = mapper_read(addr);
                         SRL(data);
                         mapper_write(addr, data);
-                        std::clog << "SRL (IX+d)\n";
+                        Z80_LOG << "SRL (IX+d)\n";
                         return 23;
                     }
                 }
@@ -0,0 +1,281 @@
+#include "jit.h"
+#include "Z80.h"
+#include <cstring>
+#include <cstdint>
+#include <initializer_list>
+#include <sys/mman.h>
+
+// Longest block compiled, a bank switch or the budget can still end it early
+static const int maxBlockInstructions = 64;
+
+static const size_t arenaSize = 8 * 1024 * 1024;
+
+// Worst case size of one compiled block
+static const size_t maxBlockCode = 64 + maxBlockInstructions * 64;
+
+/* Instruction lengths of the opcodes the blocks walk over, 0 ends the block before it */
+
+static int opcodeLength(uint8_t op) {
+
+    // LD r,n  ALU n  DJNZ  JR  JR cc  OUT (n),A  IN A,(n)  CB prefix
+    if((op & 0xC7) == 0x06 || (op & 0xC7) == 0xC6 || (op & 0xE7) == 0x20 ||
+        op == 0x10 || op == 0x18 || op == 0xD3 || op == 0xDB || op == 0xCB)
+        return 2;
+
+    // LD rr,nn  LD (nn),HL  LD HL,(nn)  LD (nn),A  LD A,(nn)  JP  JP cc  CALL  CALL cc
+    if((op & 0xCF) == 0x01 || op == 0x22 || op == 0x2A || op == 0x32 || op == 0x3A ||
+        op == 0xC3 || (op & 0xC7) == 0xC2 || op == 0xCD || (op & 0xC7) == 0xC4)
+        return 3;
+
+    return 1;
+}
+
+// Opcodes whose (HL) becomes (IX+d) with a displacement byte
+static bool indexedMemory(uint8_t op) {
+
+    if(op == 0x34 || op == 0x35 || op == 0x36)
+        return true;
+
+    if(op == 0x76)
+        return false;
+
+    if(op >= 0x40 && op <= 0x7F)
+        return (op & 0x07) == 0x06 || (op & 0xF8) == 0x70;
+
+    return op >= 0x80 && op <= 0xBF && (op & 0x07) == 0x06;
+}
+
+static int instructionLength(const uint8_t* byte) {
+
+    if(byte[0] == 0xED)
+        return ((byte[1] & 0xC7) == 0x43) ? 4 : 2;
+
+    if(byte[0] == 0xDD || byte[0] == 0xFD) {
+
+        if(byte[1] == 0xCB)
+            return 4;
+
+        // Stacked prefixes are left to the interpreter
+        if(byte[1] == 0xDD || byte[1] == 0xED || byte[1] == 0xFD)
+            return 0;
+
+        return 1 + opcodeLength(byte[1]) + (indexedMemory(byte[1]) ? 1 : 0);
+    }
+    return opcodeLength(byte[0]);
+}
+
+// Jumps, calls, returns and restarts are the last instruction of a block
+static bool endsBlock(const uint8_t* byte) {
+    uint8_t op = byte[0];
+
+    if(op == 0xED)
+        return (byte[1] & 0xC7) == 0x45;
+
+    if(op == 0xDD || op == 0xFD)
+        return byte[1] == 0xE9;
+
+    return op == 0x10 || op == 0x18 || (op & 0xE7) == 0x20 || op == 0xC3 || (op & 0xC7) == 0xC2 ||
+        op == 0xCD || (op & 0xC7) == 0xC4 || op == 0xC9 || (op & 0xC7) == 0xC0 || (op & 0xC7) == 0xC7 || op == 0xE9;
+}
+
+/* Machine code emission */
+
+struct Emitter {
+    uint8_t* ptr;
+
+    void bytes(std::initializer_list<uint8_t> list) {
+        for(uint8_t b : list)
+            *ptr++ = b;
+    }
+
+    void imm64(const void* value) {
+        uint64_t v = (uint64_t)(uintptr_t)value;
+        std::memcpy(ptr, &v, 8);
+        ptr += 8;
+    }
+
+    // Jump with a 32bit displacement patched once the target is known
+    uint8_t* jump(std::initializer_list<uint8_t> opcode) {
+        bytes(opcode);
+        ptr += 4;
+        return ptr - 4;
+    }
+
+    void patch(uint8_t* at, const uint8_t* target) {
+        int32_t rel = (int32_t)(target - (at + 4));
+        std::memcpy(at, &rel, 4);
+    }
+};
+
+Z80JIT::Z80JIT() {
+    codeSize = 0;
+    codeUsed = 0;
+    base = NULL;
+    size = 0;
+
+    void* mem = mmap(NULL, arenaSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    code = (mem != MAP_FAILED) ? (uint8_t*)mem : NULL;
+
+    if(code)
+        codeSize = arenaSize;
+}
+
+Z80JIT::~Z80JIT() {
+
+    if(code)
+        munmap(code, codeSize);
+}
+
+void Z80JIT::flush() {
+    blocks.assign(size, 0);
+    codeUsed = 0;
+}
+
+int Z80JIT::step(Z80* cpu, const uint8_t* byte, uint8_t* decoded) {
+    uint16_t pc = cpu->programCounter;
+
+    // The page under the block was switched, or its instruction lengths went astray
+    if((pc & 0x3ff) > 0x3fc || !cpu->fetchPage[pc >> 10] || cpu->fetchPage[pc >> 10] + (pc & 0x3ff) != byte)
+        return -1;
+
+    return cpu->execute(byte, decoded);
+}
+
+Z80JIT::Block Z80JIT::compile(size_t offset) {
+
+    if(codeUsed + maxBlockCode > codeSize)
+        flush();
+
+    // Walk the straight line of code, staying inside the 1kb page it starts in
+    std::vector<size_t> instructions;
+    size_t at = offset;
+
+    while((int)instructions.size() < maxBlockInstructions && (at & 0x3ff) <= 0x3fc && at + 4 <= size) {
+        const uint8_t* byte = base + at;
+        int length = instructionLength(byte);
+
+        if(length == 0 || Z80::isEventOpcode(byte) || (at & 0x3ff) + length > 0x400)
+            break;
+
+        instructions.push_back(at);
+        at += length;
+
+        if(endsBlock(byte))
+            break;
+    }
+
+    if(instructions.empty())
+        return NULL;
+
+    if(mprotect(code, codeSize, PROT_READ | PROT_WRITE) != 0)
+        return NULL;
+
+    uint8_t* start = code + codeUsed;
+    Emitter e { start };
+    std::vector<uint8_t*> exits;
+
+    // rbx cpu, r12d cycles, r13d budget, r14d odd cycle instructions, the stack stays 16 byte aligned
+    e.bytes({ 0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56 });  // push rbx, r12, r13, r14
+    e.bytes({ 0x48, 0x83, 0xEC, 0x08 });                    // sub rsp, 8
+    e.bytes({ 0x48, 0x89, 0xFB });                          // mov rbx, rdi
+    e.bytes({ 0x41, 0x89, 0xF5 });                          // mov r13d, esi
+    e.bytes({ 0x45, 0x31, 0xE4 });                          // xor r12d, r12d
+    e.bytes({ 0x45, 0x31, 0xF6 });                          // xor r14d, r14d
+
+    for(size_t i = 0; i < instructions.size(); i ++) {
+
+        e.bytes({ 0x48, 0x89, 0xDF });                      // mov rdi, rbx
+        e.bytes({ 0x48, 0xBE });                            // mov rsi, instruction bytes
+        e.imm64(base + instructions[i]);
+        e.bytes({ 0x48, 0xBA });                            // mov rdx, predecoded group
+        e.imm64(decodeCache->data() + instructions[i]);
+        e.bytes({ 0x48, 0xB8 });                            // mov rax, step
+        e.imm64((const void*)&Z80JIT::step);
+        e.bytes({ 0xFF, 0xD0 });                            // call rax
+
+        e.bytes({ 0x85, 0xC0 });                            // test eax, eax
+        exits.push_back(e.jump({ 0x0F, 0x8E }));            // jle exit
+
+        e.bytes({ 0x41, 0x01, 0xC4 });                      // add r12d, eax
+        e.bytes({ 0x83, 0xE0, 0x01 });                      // and eax, 1
+        e.bytes({ 0x41, 0x01, 0xC6 });                      // add r14d, eax
+
+        // Stop on the same instruction the interpreter would
+        if(i + 1 < instructions.size()) {
+            e.bytes({ 0x45, 0x39, 0xEC });                  // cmp r12d, r13d
+            exits.push_back(e.jump({ 0x0F, 0x8D }));        // jge exit
+        }
+    }
+
+    for(uint8_t* at : exits)
+        e.patch(at, e.ptr);
+
+    e.bytes({ 0x4C, 0x89, 0xF0 });                          // mov rax, r14
+    e.bytes({ 0x48, 0xC1, 0xE0, 0x20 });                    // shl rax, 32
+    e.bytes({ 0x44, 0x89, 0xE2 });                          // mov edx, r12d
+    e.bytes({ 0x48, 0x09, 0xD0 });                          // or rax, rdx
+    e.bytes({ 0x48, 0x83, 0xC4, 0x08 });                    // add rsp, 8
+    e.bytes({ 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5B });  // pop r14, r13, r12, rbx
+    e.bytes({ 0xC3 });                                      // ret
+
+    mprotect(code, codeSize, PROT_READ | PROT_EXEC);
+
+    blocks[offset] = codeUsed + 1;
+    codeUsed = e.ptr - code;
+
+    return (Block)start;
+}
+
+int Z80JIT::run(Z80& cpu, int budget) {
+    int cycles = 0;
+    int odd = 0;
+
+    // A new rom or a rebuilt decode cache leaves every block stale
+    if(cpu.decodeBase != base || cpu.decodeCache != decodeCache || cpu.decodeCache->size() != size) {
+        base = cpu.decodeBase;
+        decodeCache = cpu.decodeCache;
+        size = decodeCache->size();
+        flush();
+    }
+
+    uint8_t byte[4];
+
+    while(cycles < budget && cpu.loopBranch < 0) {
+        uint16_t pc = cpu.programCounter;
+
+        const uint8_t* page = (code && cpu.fetchPage && (pc & 0x3ff) <= 0x3fc) ? cpu.fetchPage[pc >> 10] : NULL;
+        size_t offset = (page) ? (uintptr_t)(page + (pc & 0x3ff)) - (uintptr_t)base : size;
+
+        if(offset < size && blocks[offset] != UINT32_MAX) {
+            Block block = (blocks[offset]) ? (Block)(code + blocks[offset] - 1) : compile(offset);
+
+            if(!block && blocks[offset] == 0)
+                blocks[offset] = UINT32_MAX;
+
+            uint64_t res = (block) ? block(&cpu, budget - cycles) : 0;
+
+            if((uint32_t)res > 0) {
+                cycles += (uint32_t)res;
+                odd += res >> 32;
+                continue;
+            }
+        }
+
+        // Code in ram, or an instruction a block cannot start with
+        uint8_t* decoded = cpu.fetch(byte);
+
+        if(Z80::isEventOpcode(byte))
+            break;
+
+        int res = cpu.execute(byte, decoded);
+
+        if(res <= 0)
+            break;
+
+        cycles += res;
+        odd += cpu.oddInstructions;
+    }
+
+    cpu.oddInstructions = odd;
+    return cycles;
+}
\ No newline at end of file
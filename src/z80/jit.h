@@ -0,0 +1,44 @@
+#ifndef Z80_JIT_H
+#define Z80_JIT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory>
+
+struct Z80;
+
+// Recompiles straight runs of read only code into x86-64 calls of the instruction handlers
+struct Z80JIT {
+
+    Z80JIT();
+    ~Z80JIT();
+
+    // Same contract as Z80::run, compiled blocks where the code is in read only memory
+    int run(Z80& cpu, int budget);
+
+private:
+
+    // Returns the cycles run in the low half and the odd cycle instructions in the high half
+    typedef uint64_t (*Block)(Z80* cpu, int budget);
+
+    Block compile(size_t offset);
+    void flush();
+
+    static int step(Z80* cpu, const uint8_t* byte, uint8_t* decoded);
+
+    // Executable memory, only writable while a block is being compiled
+    uint8_t* code;
+    size_t codeSize;
+    size_t codeUsed;
+
+    // Block at every offset of read only memory, code offset + 1, 0 not compiled yet or UINT32_MAX when none can start there
+    std::vector<uint32_t> blocks;
+
+    // What the blocks were compiled against, the cache is held as blocks point into it
+    const uint8_t* base;
+    std::shared_ptr<std::vector<uint8_t>> decodeCache;
+    size_t size;
+};
+
+#endif
\ No newline at end of file
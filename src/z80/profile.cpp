@@ -0,0 +1,75 @@
+#include "Z80.h"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+static const char* groupNames[] {
+    "", "CB", "ED", "DD", "FD", "DDCB", "FDCB"
+};
+
+void Z80::profileInstruction(const uint8_t* byte, int res) {
+    int group = Profile_None;
+    uint8_t opcode = byte[0];
+
+    // Prefixed opcodes are counted under the byte after the prefix, DDCB and FDCB under the last byte
+    switch(byte[0]) {
+        case 0xCB: group = Profile_CB; opcode = byte[1]; break;
+        case 0xED: group = Profile_ED; opcode = byte[1]; break;
+
+        case 0xDD: case 0xFD:
+        {
+            bool x = (byte[0] == 0xDD);
+
+            if(byte[1] == 0xCB) {
+                group = (x) ? Profile_DDCB : Profile_FDCB;
+                opcode = byte[3];
+
+            }else {
+                group = (x) ? Profile_DD : Profile_FD;
+                opcode = byte[1];
+            }
+            break;
+        }
+    }
+
+    OpcodeProfile& entry = profile[group * 256 + opcode];
+    entry.count ++;
+    entry.cycles += res;
+    entry.histogram[std::min(res, profileBuckets - 1)] ++;
+}
+
+void Z80::writeProfile(std::ostream& out) {
+    std::vector<int> used;
+    uint64_t total = 0;
+
+    for(size_t i = 0; i < profile.size(); i ++) {
+
+        if(profile[i].count > 0) {
+            used.push_back(i);
+            total += profile[i].cycles;
+        }
+    }
+
+    std::sort(used.begin(), used.end(), [this](int a, int b) {
+        return profile[a].cycles > profile[b].cycles;
+    });
+
+    out << "opcode      count         cycles   share  cycles:count\n";
+
+    for(int i : used) {
+        const OpcodeProfile& entry = profile[i];
+
+        std::string name = std::string(groupNames[i / 256]) + (i / 256 ? " " : "");
+        out << std::left << std::setw(8) << name << std::right << std::hex << std::setfill('0') << std::setw(2) << (i % 256);
+        out << std::dec << std::setfill(' ') << std::setw(11) << entry.count << std::setw(15) << entry.cycles;
+        out << std::setw(7) << std::fixed << std::setprecision(2) << (total ? 100.0 * entry.cycles / total : 0) << "% ";
+
+        for(int b = 0; b < profileBuckets; b ++) {
+
+            if(entry.histogram[b] > 0)
+                out << " " << b << (b == profileBuckets - 1 ? "+" : "") << ":" << entry.histogram[b];
+        }
+        out << "\n";
+    }
+    out << "total cycles " << total << "\n";
+}
\ No newline at end of file
@@ -2,6 +2,14 @@
 #define Z80_UTILITIES_H
 
 #include <cstdint>
+#include <iostream>
+
+// Disassembly of every instruction, compiled out unless tracing so instances share no stream state
+#ifdef Z80_TRACE
+#define Z80_LOG std::clog
+#else
+#define Z80_LOG if(true) {} else std::clog
+#endif
 
 static inline uint16_t pairBytes(uint8_t hi, uint8_t lo) {
     return ((uint16_t)hi << 8) + (uint16_t)lo;
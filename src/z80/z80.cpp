@@ -2,8 +2,41 @@
 #include "utilities.h"
 #include <bitset>
 #include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <initializer_list>
+
+#ifdef Z80_JIT
+#include "jit.h"
+#endif
+
+const uint8_t Z80::rrrRegister[8] {
+    B, C, D, E, H, L, F, A
+};
+
+int (Z80::*const Z80::groups[])(const uint8_t*) {
+    &Z80::process8BitLoadGroup,
+    &Z80::process16BitLoadGroup,
+    &Z80::processExchangeSearchGroup,
+    &Z80::processGeneralArithmeticGroup,
+    &Z80::process8BitArithmeticGroup,
+    &Z80::process16BitArithmeticGroup,
+    &Z80::processRotateShiftGroup,
+    &Z80::processBitSetResetTest,
+    &Z80::processJumpGroup,
+    &Z80::processCallReturnGroup,
+    &Z80::processInputOutputGroup
+};
 
 Z80::Z80() {
+
+    // Power on with known values so runs are repeatable
+    for(int i = 0; i < 16; i ++)
+        reg[i] = 0;
+
+    indexRegisterX = 0;
+    indexRegisterY = 0;
+    stackPointer = 0;
     programCounter = 0;
     interruptMode = 0;
     interruptVector = 0;
@@ -12,41 +45,269 @@ Z80::Z80() {
     IFF2 = 0;
     haltState = HALT_NONE;
     eiState = EI_NONE;
+    intLine = false;
+    oddInstructions = 0;
+    loopBranch = -1;
+    loopSideEffect = false;
+    fetchPage = NULL;
+    decodeBase = NULL;
+    std::memset(opcodeGroup, 0, sizeof(opcodeGroup));
+
+#ifdef Z80_JIT
+    jitEnabled = true;
+#endif
+
+#ifdef Z80_LAZY_FLAGS
+    lazyOp = Flags_None;
+#endif
+
+#ifdef Z80_PROFILE
+    profile.assign(Profile_Groups * 256, OpcodeProfile {});
+#endif
+
+    // Pairs each 2bit operand field selects
+    auto table = [](uint16_t** to, std::initializer_list<uint16_t*> from) {
+        std::copy(from.begin(), from.end(), to);
+    };
+    table(ddPair, { &pair[BC], &pair[DE], &pair[HL], &stackPointer });
+    table(qqPair, { &pair[BC], &pair[DE], &pair[HL], &pair[AF] });
+    table(ppPair, { &pair[BC], &pair[DE], &indexRegisterX, &stackPointer });
+    table(rrPair, { &pair[BC], &pair[DE], &indexRegisterY, &stackPointer });
+}
+
+Z80::~Z80() {
 }
 
 int Z80::cycle() {
+    uint8_t byte[4];
+    uint8_t* decoded = fetch(byte);
+
+    int res = execute(byte, decoded);
+
+    // Callers see F up to date
+    flushFlags();
+    return res;
+}
+
+uint8_t* Z80::fetch(uint8_t* byte) {
+    uint8_t* decoded = NULL;
+
+    const uint8_t* page = (fetchPage && (programCounter & 0x3ff) <= 0x3fc) ? fetchPage[programCounter >> 10] : NULL;
+
+    if(page) {
+        const uint8_t* ptr = page + (programCounter & 0x3ff);
+        std::memcpy(byte, ptr, 4);
+
+        // The group decoding the bytes at this spot of read only memory
+        size_t offset = (uintptr_t)ptr - (uintptr_t)decodeBase;
+
+        if(decodeBase && offset < decodeCache->size())
+            decoded = decodeCache->data() + offset;
+
+    }else {
+
+        for(int i = 0; i < 4; i ++)
+            byte[i] = mapper_read(programCounter + i);
+    }
+    return decoded;
+}
+
+int Z80::execute(const uint8_t* byte, uint8_t* decoded) {
+    uint16_t start = beginInstruction();
+
+    // Group already known from the predecode cache or the opcode
+    int group = (decoded && *decoded) ? *decoded : opcodeGroup[byte[0]];
+    int res = (group) ? (this->*groups[group - 1])(byte) : 0;
+
+    if(res == 0)
+        res = decodeGroups(byte, decoded);
+
+    return endInstruction(byte, res, start);
+}
+
+uint16_t Z80::beginInstruction() {
 
     // Process the next instruction after an EI
     if(eiState == EI_WAIT) {
         eiState = EI_GOOD;
     }
 
-    std::clog << std::hex << (int)programCounter << ": ";
+    Z80_LOG << std::hex << (int)programCounter << ": ";
+
+    oddInstructions = 0;
+    return programCounter;
+}
 
+int Z80::decodeGroups(const uint8_t* byte, uint8_t* decoded) {
     int res = 0;
-    
-    if(res == 0) res = process8BitLoadGroup();
-    if(res == 0) res = process16BitLoadGroup();
-    if(res == 0) res = processExchangeSearchGroup();
-    if(res == 0) res = processGeneralArithmeticGroup();
-    if(res == 0) res = process8BitArithmeticGroup();
-    if(res == 0) res = process16BitArithmeticGroup();
-    if(res == 0) res = processRotateShiftGroup();
-    if(res == 0) res = processBitSetResetTest();
-    if(res == 0) res = processJumpGroup();
-    if(res == 0) res = processCallReturnGroup();
-    if(res == 0) res = processInputOutputGroup();
-
-    // Processed the instruction, reenable interrupts
+
+    for(size_t i = 0; i < sizeof(groups) / sizeof(groups[0]) && res == 0; i ++) {
+        res = (this->*groups[i])(byte);
+
+        if(res == 0)
+            continue;
+
+        if(decoded)
+            *decoded = i + 1;
+
+        // Prefixed opcodes are shared between groups, the rest belong to one
+        if(byte[0] != 0xCB && byte[0] != 0xDD && byte[0] != 0xED && byte[0] != 0xFD)
+            opcodeGroup[byte[0]] = i + 1;
+    }
+    return res;
+}
+
+int Z80::endInstruction([[maybe_unused]] const uint8_t* byte, int res, uint16_t start) {
+
+    // Polling loops close with a jump back
+    if(programCounter <= start)
+        loopBranch = programCounter;
+
+    // Processed the instruction, reenable interrupts and take one already waiting
     if(eiState == EI_GOOD) {
         eiState = EI_NONE;
         IFF1 = 1;
         IFF2 = 1;
+
+        if(intLine)
+            signalINT();
     }
 
+    // A single instruction rounds as a whole
+    if(oddInstructions == 0)
+        oddInstructions = res & 1;
+
+#ifdef Z80_PROFILE
+    if(res > 0) {
+        profileInstruction(byte, res);
+
+        if(instructionHook)
+            instructionHook(start, byte, res);
+    }
+#endif
+
     return res;
 }
 
+// Ports need the other devices caught up, block transfers and HALT ask them for the next event
+// RETN can let in an interrupt held on the line, which is taken between single steps
+bool Z80::isEventOpcode(const uint8_t* byte) {
+
+    if(byte[0] == 0xED)
+        return (byte[1] & 0xC6) == 0x40 || byte[1] == 0x45 || (byte[1] >= 0xA0 && byte[1] <= 0xBF);
+
+    return byte[0] == 0xDB || byte[0] == 0xD3 || byte[0] == 0x76;
+}
+
+int Z80::run(int budget) {
+
+#ifdef Z80_JIT
+    // Code in read only memory runs as compiled blocks
+    if(decodeBase && jitEnabled) {
+
+        if(!jit)
+            jit = std::make_unique<Z80JIT>();
+
+        int cycles = jit->run(*this, budget);
+
+        flushFlags();
+        return cycles;
+    }
+#endif
+
+    int cycles = 0;
+    int odd = 0;
+
+    uint8_t byte[4];
+    uint8_t* decoded;
+    int res;
+
+#ifdef Z80_THREADED_CODE
+    uint16_t start;
+
+    // Handler of each group, the first one decodes through all of them
+    static void* const handlers[] {
+        &&decode,
+        &&group1, &&group2, &&group3, &&group4, &&group5, &&group6,
+        &&group7, &&group8, &&group9, &&group10, &&group11
+    };
+
+    // Fetch the next instruction and jump straight to the handler of its group
+    #define Z80_DISPATCH()                                                                  \
+        if(cycles >= budget || loopBranch >= 0)                                             \
+            goto done;                                                                      \
+        decoded = fetch(byte);                                                              \
+        if(isEventOpcode(byte))                                                             \
+            goto done;                                                                      \
+        start = beginInstruction();                                                         \
+        goto *handlers[(decoded && *decoded) ? *decoded : opcodeGroup[byte[0]]];
+
+    // Run a group, retire the instruction and dispatch the next from the tail
+    #define Z80_HANDLER(label, function)                                                    \
+        label:                                                                              \
+            res = function(byte);                                                           \
+            if(res == 0)                                                                    \
+                res = decodeGroups(byte, decoded);                                          \
+            if(endInstruction(byte, res, start) <= 0)                                       \
+                goto done;                                                                  \
+            cycles += res;                                                                  \
+            odd += oddInstructions;                                                         \
+            Z80_DISPATCH()
+
+    Z80_DISPATCH()
+
+    decode:
+        res = decodeGroups(byte, decoded);
+
+        if(endInstruction(byte, res, start) <= 0)
+            goto done;
+
+        cycles += res;
+        odd += oddInstructions;
+        Z80_DISPATCH()
+
+    Z80_HANDLER(group1, process8BitLoadGroup)
+    Z80_HANDLER(group2, process16BitLoadGroup)
+    Z80_HANDLER(group3, processExchangeSearchGroup)
+    Z80_HANDLER(group4, processGeneralArithmeticGroup)
+    Z80_HANDLER(group5, process8BitArithmeticGroup)
+    Z80_HANDLER(group6, process16BitArithmeticGroup)
+    Z80_HANDLER(group7, processRotateShiftGroup)
+    Z80_HANDLER(group8, processBitSetResetTest)
+    Z80_HANDLER(group9, processJumpGroup)
+    Z80_HANDLER(group10, processCallReturnGroup)
+    Z80_HANDLER(group11, processInputOutputGroup)
+
+    #undef Z80_HANDLER
+    #undef Z80_DISPATCH
+
+    done:
+
+#else
+
+    while(cycles < budget && loopBranch < 0) {
+        decoded = fetch(byte);
+
+        if(isEventOpcode(byte))
+            break;
+
+        res = execute(byte, decoded);
+
+        if(res <= 0)
+            break;
+
+        cycles += res;
+        odd += oddInstructions;
+    }
+
+#endif
+
+    oddInstructions = odd;
+
+    flushFlags();
+    return cycles;
+}
+
 void Z80::signalNMI() {
 
     if(haltState == HALT_WAIT) {
@@ -71,6 +332,10 @@ void Z80::signalINT() {
         return;
     }
 
+    // Already woken, the interrupt is taken once the HALT has stepped past itself
+    if(haltState == HALT_GOOD)
+        return;
+
     // Do not capture this interrupt
     if(IFF1 == 0)
         return;
@@ -82,10 +347,20 @@ void Z80::signalINT() {
     IFF1 = 0;
     IFF2 = 0;
 
-    programCounter = 0x0038;
+    // Mode 2 jumps through a table at I, the low byte comes off the bus which floats high
+    if(interruptMode == 2) {
+        uint16_t vector = (interruptVector << 8) | 0xFF;
+        programCounter = mapper_read(vector) | (mapper_read(vector + 1) << 8);
+
+    // Mode 0 executes the RST 38h on the floating bus, the same as mode 1
+    }else {
+        programCounter = 0x0038;
+    }
 }
 
 void Z80::setFlag(uint8_t flag, bool val) {
+    flushFlags();
+
     reg[F] &= ~flag;
 
     if(val)
@@ -93,9 +368,149 @@ void Z80::setFlag(uint8_t flag, bool val) {
 }
 
 bool Z80::getFlag(uint8_t flag) {
+    flushFlags();
+
     return reg[F] & flag;
 }
 
+const uint8_t Z80::flagMask[] {
+    0,
+    Sign | Zero | HalfCarry | ParityOverflow | AddSubtract | Carry,     // ADD
+    Sign | Zero | HalfCarry | ParityOverflow | AddSubtract | Carry,     // ADC
+    Sign | Zero | HalfCarry | ParityOverflow | AddSubtract | Carry,     // SUB
+    Sign | Zero | HalfCarry | ParityOverflow | AddSubtract | Carry,     // SBC
+    Sign | Zero | HalfCarry | ParityOverflow | AddSubtract | Carry,     // AND
+    Sign | Zero | HalfCarry | ParityOverflow | AddSubtract | Carry,     // OR
+    Sign | Zero | HalfCarry | ParityOverflow | AddSubtract | Carry,     // XOR
+    Sign | Zero | HalfCarry | ParityOverflow | AddSubtract | Carry,     // CP
+    Sign | Zero | HalfCarry | ParityOverflow | AddSubtract,             // INC
+    Sign | Zero | HalfCarry | ParityOverflow | AddSubtract,             // DEC
+    HalfCarry | AddSubtract | Carry,                                    // ADD16
+    Sign | Zero | HalfCarry | ParityOverflow | AddSubtract | Carry,     // ADC16
+    Sign | Zero | HalfCarry | ParityOverflow | AddSubtract | Carry      // SBC16
+};
+
+uint8_t Z80::computeFlags(uint8_t op, uint16_t a, uint16_t b, uint8_t c) {
+    uint8_t flags = 0;
+
+    auto set = [&flags](uint8_t flag, bool val) {
+        if(val) flags |= flag;
+    };
+
+    switch(op) {
+
+        case Flags_Add: case Flags_Adc:
+        {
+            uint8_t res = a + b + c;
+            set(Sign, res & 0b10000000);
+            set(Zero, res == 0);
+            set(ParityOverflow, overflow8(0, a, b, c));
+            set(HalfCarry, halfCarry8(a, b, c));
+            set(Carry, carry8(a, b, c));
+            break;
+        }
+
+        case Flags_Sub: case Flags_Sbc: case Flags_Cp:
+        {
+            uint8_t res = a - b - c;
+            set(Sign, res & 0b10000000);
+            set(Zero, res == 0);
+            set(ParityOverflow, overflow8(1, a, b, c));
+            set(AddSubtract, 1);
+            set(HalfCarry, halfBorrow8(a, b, c));
+            set(Carry, borrow8(a, b, c));
+            break;
+        }
+
+        case Flags_And: case Flags_Or: case Flags_Xor:
+        {
+            uint8_t res = (op == Flags_And) ? (a & b) : (op == Flags_Or) ? (a | b) : (a ^ b);
+            set(Sign, res & 0b10000000);
+            set(Zero, res == 0);
+            set(ParityOverflow, std::bitset<8>(res).count() % 2 == 0);
+            set(HalfCarry, op == Flags_And);
+            break;
+        }
+
+        case Flags_Inc:
+        {
+            uint8_t res = a + 1;
+            set(Sign, res & 0b10000000);
+            set(Zero, res == 0);
+            set(ParityOverflow, a == 0x7F);
+            set(HalfCarry, halfCarry8(a, 1));
+            break;
+        }
+
+        case Flags_Dec:
+        {
+            uint8_t res = a - 1;
+            set(Sign, res & 0b10000000);
+            set(Zero, res == 0);
+            set(ParityOverflow, a == 0x80);
+            set(AddSubtract, 1);
+            set(HalfCarry, halfBorrow8(a, 1));
+            break;
+        }
+
+        case Flags_Add16:
+        {
+            set(HalfCarry, halfCarry16(a, b));
+            set(Carry, carry16(a, b));
+            break;
+        }
+
+        case Flags_Adc16:
+        {
+            uint16_t res = a + b + c;
+            set(Sign, res & 0b1000000000000000);
+            set(Zero, res == 0);
+            set(HalfCarry, halfCarry16(a, b, c));
+            set(ParityOverflow, overflow16(0, a, b, c));
+            set(Carry, carry16(a, b, c));
+            break;
+        }
+
+        case Flags_Sbc16:
+        {
+            uint16_t res = a - b - c;
+            set(Sign, res & 0b1000000000000000);
+            set(Zero, res == 0);
+            set(HalfCarry, halfBorrow16(a, b, c));
+            set(ParityOverflow, overflow16(1, a, b, c));
+            set(AddSubtract, 1);
+            set(Carry, borrow16(a, b, c));
+            break;
+        }
+    }
+    return flags;
+}
+
+void Z80::updateFlags(uint8_t op, uint16_t a, uint16_t b, uint8_t c) {
+#ifdef Z80_LAZY_FLAGS
+
+    // Operations keeping some of F need the pending one in it first, the rest replace it
+    if(flagMask[op] != flagMask[Flags_Add])
+        flushFlags();
+
+    lazyOp = op;
+    lazyA = a;
+    lazyB = b;
+    lazyCarry = c;
+#else
+    reg[F] = (reg[F] & ~flagMask[op]) | computeFlags(op, a, b, c);
+#endif
+}
+
+#ifdef Z80_LAZY_FLAGS
+void Z80::materialiseFlags() {
+    uint8_t op = lazyOp;
+    lazyOp = Flags_None;
+
+    reg[F] = (reg[F] & ~flagMask[op]) | computeFlags(op, lazyA, lazyB, lazyCarry);
+}
+#endif
+
 void Z80::incrementPC(int val) {
     programCounter += val;
     
@@ -108,170 +523,72 @@ void Z80::incrementPC(int val) {
 }
 
 void Z80::ADD(uint8_t& a, const uint8_t& b) {
-    uint8_t res = a + b;
-
-    setFlag(Sign, res & 0b10000000);
-    setFlag(Zero, res == 0);
-    setFlag(ParityOverflow, overflow8(0, a, b));
-    setFlag(AddSubtract, 0);
-    setFlag(HalfCarry, halfCarry8(a, b));
-    setFlag(Carry, carry8(a, b));
-
-    a = res;
+    updateFlags(Flags_Add, a, b);
+    a += b;
 }
 
 void Z80::ADC(uint8_t& a, const uint8_t& b) {
     uint8_t c = getFlag(Carry);
-    uint8_t res = a + b + c;
-
-    setFlag(Sign, res & 0b10000000);
-    setFlag(Zero, res == 0);
-    setFlag(ParityOverflow, overflow8(0, a, b, c));
-    setFlag(AddSubtract, 0);
-    setFlag(HalfCarry, halfCarry8(a, b, c));
-    setFlag(Carry, carry8(a, b, c));
-
-    a = res;
+    updateFlags(Flags_Adc, a, b, c);
+    a += b + c;
 }
 
 void Z80::SUB(uint8_t& a, const uint8_t& b) {
-    uint8_t res = a - b;
-
-    setFlag(Sign, res & 0b10000000);
-    setFlag(Zero, res == 0);
-    setFlag(ParityOverflow, overflow8(1, a, b));
-    setFlag(AddSubtract, 1);
-    setFlag(HalfCarry, halfBorrow8(a, b));
-    setFlag(Carry, borrow8(a, b));
-
-    a = res;
+    updateFlags(Flags_Sub, a, b);
+    a -= b;
 }
 
 void Z80::SBC(uint8_t& a, const uint8_t& b) {
     uint8_t c = getFlag(Carry);
-    uint8_t res = a - b - c;
-
-    setFlag(Sign, res & 0b10000000);
-    setFlag(Zero, res == 0);
-    setFlag(ParityOverflow, overflow8(1, a, b, c));
-    setFlag(AddSubtract, 1);
-    setFlag(HalfCarry, halfBorrow8(a, b, c));
-    setFlag(Carry, borrow8(a, b, c));
-
-    a = res;
+    updateFlags(Flags_Sbc, a, b, c);
+    a -= b + c;
 }
 
 void Z80::AND(uint8_t& a, const uint8_t& b) {
-    uint8_t res = a & b;
-
-    setFlag(Sign, res & 0b10000000);
-    setFlag(Zero, res == 0);
-    setFlag(ParityOverflow, std::bitset<8>(res).count() % 2 == 0);
-    setFlag(AddSubtract, 0);
-    setFlag(HalfCarry, 1);
-    setFlag(Carry, 0);
-
-    a = res;
+    updateFlags(Flags_And, a, b);
+    a &= b;
 }
 
 void Z80::OR(uint8_t& a, const uint8_t& b) {
-    uint8_t res = a | b;
-
-    setFlag(Sign, res & 0b10000000);
-    setFlag(Zero, res == 0);
-    setFlag(ParityOverflow, std::bitset<8>(res).count() % 2 == 0);
-    setFlag(AddSubtract, 0);
-    setFlag(HalfCarry, 0);
-    setFlag(Carry, 0);
-
-    a = res;
+    updateFlags(Flags_Or, a, b);
+    a |= b;
 }
 
 void Z80::XOR(uint8_t& a, const uint8_t& b) {
-    uint8_t res = a ^ b;
-
-    setFlag(Sign, res & 0b10000000);
-    setFlag(Zero, res == 0);
-    setFlag(ParityOverflow, std::bitset<8>(res).count() % 2 == 0);
-    setFlag(AddSubtract, 0);
-    setFlag(HalfCarry, 0);
-    setFlag(Carry, 0);
-
-    a = res;
+    updateFlags(Flags_Xor, a, b);
+    a ^= b;
 }
 
 
 void Z80::CP(const uint8_t& a, const uint8_t& b) {
-    uint8_t res = a - b;
-
-    setFlag(Sign, res & 0b10000000);
-    setFlag(Zero, res == 0);
-    setFlag(ParityOverflow, overflow8(1, a, b));
-    setFlag(AddSubtract, 1);
-    setFlag(HalfCarry, halfBorrow8(a, b));
-    setFlag(Carry, borrow8(a, b));
+    updateFlags(Flags_Cp, a, b);
 }
 
 void Z80::INC(uint8_t& a) {
-    uint8_t res = a + 1;
-
-    setFlag(Sign, res & 0b10000000);
-    setFlag(Zero, res == 0);
-    setFlag(ParityOverflow, a == 0x7F);
-    setFlag(AddSubtract, 0);
-    setFlag(HalfCarry, halfCarry8(a, 1));
-
-    a = res;
+    updateFlags(Flags_Inc, a, 1);
+    a += 1;
 }
 
 void Z80::DEC(uint8_t& a) {
-    uint8_t res = a - 1;
-
-    setFlag(Sign, res & 0b10000000);
-    setFlag(Zero, res == 0);
-    setFlag(ParityOverflow, a == 0x80);
-    setFlag(AddSubtract, 1);
-    setFlag(HalfCarry, halfBorrow8(a, 1));
-
-    a = res;
+    updateFlags(Flags_Dec, a, 1);
+    a -= 1;
 }
 
 void Z80::ADD16(uint16_t& a, const uint16_t& b) {
-    uint16_t res = a + b;
-
-    setFlag(HalfCarry, halfCarry16(a, b));
-    setFlag(AddSubtract, 0);
-    setFlag(Carry, carry16(a, b));
-
-    a = res;
+    updateFlags(Flags_Add16, a, b);
+    a += b;
 }
 
 void Z80::ADC16(uint16_t& a, const uint16_t& b) {
-    uint16_t c = getFlag(Carry);
-    uint16_t res = a + b + c;
-
-    setFlag(Sign, res & 0b1000000000000000);
-    setFlag(Zero, res == 0);
-    setFlag(HalfCarry, halfCarry16(a, b, c));
-    setFlag(ParityOverflow, overflow16(0, a, b, c));
-    setFlag(AddSubtract, 0);
-    setFlag(Carry, carry16(a, b, c));
-
-    a = res;
+    uint8_t c = getFlag(Carry);
+    updateFlags(Flags_Adc16, a, b, c);
+    a += b + c;
 }
 
 void Z80::SBC16(uint16_t& a, const uint16_t& b) {
     uint8_t c = getFlag(Carry);
-    uint16_t res = a - b - c;
-
-    setFlag(Sign, res & 0b1000000000000000);
-    setFlag(Zero, res == 0);
-    setFlag(HalfCarry, halfBorrow16(a, b, c));
-    setFlag(ParityOverflow, overflow16(1, a, b, c));
-    setFlag(AddSubtract, 1);
-    setFlag(Carry, borrow16(a, b, c));
-
-    a = res;
+    updateFlags(Flags_Sbc16, a, b, c);
+    a -= b + c;
 }
 
 void Z80::INC16(uint16_t& a) {
@@ -294,6 +611,9 @@ void Z80::RET() {
 void Z80::RETN() {
     RET();
     IFF1 = IFF2;
+
+    if(interrupt_changed)
+        interrupt_changed();
 }
 
 void Z80::RETI() {
@@ -3,15 +3,46 @@
 
 #include <cstdint>
 #include <functional>
+#include <vector>
+#include <memory>
+#include <iosfwd>
+
+#ifdef Z80_JIT
+struct Z80JIT;
+#endif
 
 struct Z80 {
 
     Z80();
+    ~Z80();
+
+    // Operand tables point into the instance
+    Z80(const Z80&) = delete;
+    Z80& operator=(const Z80&) = delete;
 
+    // Registers sit in host byte order so each pair is also one 16bit word
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
     enum RegisterNames {
         A, F, B, C, D, E, H, L, A_p, F_p, B_p, C_p, D_p, E_p, H_p, L_p
     };
 
+    enum HalfNames {
+        High, Low
+    };
+#else
+    enum RegisterNames {
+        F, A, C, B, E, D, L, H, F_p, A_p, C_p, B_p, E_p, D_p, L_p, H_p
+    };
+
+    enum HalfNames {
+        Low, High
+    };
+#endif
+
+    enum PairNames {
+        AF, BC, DE, HL, AF_p, BC_p, DE_p, HL_p
+    };
+
     enum StatusFlag {
         Sign            = 0b10000000,
         Zero            = 0b01000000,
@@ -21,13 +52,23 @@ struct Z80 {
         Carry           = 0b00000001
     };
 
-    uint8_t reg[16];
+    union {
+        uint8_t reg[16];
+        uint16_t pair[8];
+    };
 
     uint8_t interruptVector;
     uint8_t memoryRefresh;
 
-    uint16_t indexRegisterX;
-    uint16_t indexRegisterY;
+    union {
+        uint16_t indexRegisterX;
+        uint8_t indexHalfX[2];
+    };
+
+    union {
+        uint16_t indexRegisterY;
+        uint8_t indexHalfY[2];
+    };
 
     uint16_t stackPointer;
     uint16_t programCounter;
@@ -51,30 +92,127 @@ struct Z80 {
     std::function<uint8_t(uint16_t)>        mapper_read;
     std::function<void(uint16_t, uint8_t)> mapper_write;
 
+    // Called when RETN or HALT could let in an interrupt held on the line
+    std::function<void()>                  interrupt_changed;
+
+    // Level of the maskable interrupt line, taken straight away once the instruction after EI ends
+    bool intLine;
+
+    /* Optional fast paths for repeated instructions */
+
+    // Cycles until the next event of the machine, bulk runs end before it is due
+    std::function<int()>                   event_cycles;
+
+    // Writes count bytes read from memory stepping by step, false when the port needs single writes
+    std::function<bool(uint16_t, uint16_t, int, int)> port_write_block;
+
+    // Copies up to count bytes stepping by step, returns how many were copied
+    std::function<int(uint16_t, uint16_t, int, int)> mapper_copy_block;
+
+    // Instructions with an odd cycle count in the last cycle(), for callers rounding each instruction
+    int oddInstructions;
+
+    /* Optional direct fetching and predecoding */
+
+    // 1kb pages instructions are fetched from directly, NULL pages go through mapper_read
+    uint8_t* const* fetchPage;
+
+    // Read only memory whose instructions are decoded once, keyed by offset so it lasts across bank switches
+    // Cpus running the same rom can share the cache, the group at an offset only ever gets the same value
+    const uint8_t* decodeBase;
+    std::shared_ptr<std::vector<uint8_t>> decodeCache;
+
+#ifdef Z80_JIT
+    // Predecoded code runs as compiled blocks, cleared to run the same code through the interpreter
+    bool jitEnabled;
+#endif
+
+    /* Idle loop detection */
+
+    // Where the last jump back to the same or an earlier address landed, -1 once the caller has seen it
+    int loopBranch;
+
+    // Set on anything a polling loop could not repeat unchanged, callers set it for their own side effects
+    bool loopSideEffect;
+
+#ifdef Z80_PROFILE
+
+    /* Opcode profiling */
+
+    enum ProfileGroup {
+        Profile_None, Profile_CB, Profile_ED, Profile_DD, Profile_FD, Profile_DDCB, Profile_FDCB, Profile_Groups
+    };
+
+    // Cycle counts past the last bucket, like bulk repeats, share it
+    static const int profileBuckets = 32;
+
+    struct OpcodeProfile {
+        uint64_t count;
+        uint64_t cycles;
+        uint64_t histogram[profileBuckets];
+    };
+
+    // Every opcode of every prefix group, 256 per group
+    std::vector<OpcodeProfile> profile;
+
+    // Opcodes sorted by the cycles spent in them
+    void writeProfile(std::ostream& out);
+
+    // Called after every instruction with its address, bytes and cycles, for profiling the program itself
+    std::function<void(uint16_t, const uint8_t*, int)> instructionHook;
+#endif
+
 public:
     void setFlag(uint8_t flag, bool val);
     bool getFlag(uint8_t flag);
 
     int cycle();
 
+    // Runs instructions until budget cycles have passed, returns the cycles run
+    // Stops before port, block transfer, HALT and RETN instructions, after jumps back and at invalid opcodes, 0 means the next one needs cycle()
+    int run(int budget);
+
     void signalNMI();
     void signalINT();
 
 private:
-    int process8BitLoadGroup();
+
+#ifdef Z80_JIT
+    friend struct Z80JIT;
+
+    // Compiled blocks of read only code, made on the first run()
+    std::unique_ptr<Z80JIT> jit;
+#endif
+
+    // Instruction groups in the order they are tried
+    static int (Z80::*const groups[])(const uint8_t* byte);
+
+    // Group of every unprefixed opcode, learned the first time it decodes
+    uint8_t opcodeGroup[256];
+
+    uint8_t* fetch(uint8_t* byte);
+    int execute(const uint8_t* byte, uint8_t* decoded);
+    int decodeGroups(const uint8_t* byte, uint8_t* decoded);
+    uint16_t beginInstruction();
+    int endInstruction(const uint8_t* byte, int res, uint16_t start);
+    static bool isEventOpcode(const uint8_t* byte);
+
+    int process8BitLoadGroup(const uint8_t* byte);
 
     // 16bit Load Group
-    int process16BitLoadGroup();
+    int process16BitLoadGroup(const uint8_t* byte);
     void PUSH(const uint16_t& data);
     void POP(uint16_t& data);
 
-    int processExchangeSearchGroup();
-    int processGeneralArithmeticGroup();
-    int processJumpGroup();
-    int processInputOutputGroup();
+    int processExchangeSearchGroup(const uint8_t* byte);
+    int bulkCopy(int step);
+    int processGeneralArithmeticGroup(const uint8_t* byte);
+    int processJumpGroup(const uint8_t* byte);
+    int processInputOutputGroup(const uint8_t* byte);
+    int bulkOutput(int step);
 
     // 8bit Arithmetic
-    int process8BitArithmeticGroup();
+    int process8BitArithmeticGroup(const uint8_t* byte);
     void ADD(uint8_t& a, const uint8_t& b);
     void ADC(uint8_t& a, const uint8_t& b);
     void SUB(uint8_t& a, const uint8_t& b);
@@ -87,7 +225,7 @@ private:
     void DEC(uint8_t& a);
 
     //16bit Arithmetic
-    int process16BitArithmeticGroup();
+    int process16BitArithmeticGroup(const uint8_t* byte);
     void ADD16(uint16_t& a, const uint16_t& b);
     void ADC16(uint16_t& a, const uint16_t& b);
     void SBC16(uint16_t& a, const uint16_t& b);
@@ -95,7 +233,7 @@ private:
     void DEC16(uint16_t& a);
 
     // Call, return
-    int processCallReturnGroup();
+    int processCallReturnGroup(const uint8_t* byte);
     void CALL(const uint16_t& addr);
     void RST(const uint8_t& p);
     void RET();
@@ -103,13 +241,13 @@ private:
     void RETN();
 
     // Bit Set, Reset, Test
-    int processBitSetResetTest();
+    int processBitSetResetTest(const uint8_t* byte);
     void BIT(const uint8_t& bit, const uint8_t& data);
     void SET(const uint8_t& bit, uint8_t& data);
     void RES(const uint8_t& bit, uint8_t& data);
 
     // Rotate, Shift
-    int processRotateShiftGroup();
+    int processRotateShiftGroup(const uint8_t* byte);
     void RLC(uint8_t& num, bool A = false);
     void RL(uint8_t& num, bool A = false);
     void RRC(uint8_t& num, bool A = false);
@@ -119,35 +257,137 @@ private:
     void SRL(uint8_t& num);
     void SLL(uint8_t& num);
 
+    /* Flags of the arithmetic instructions, optionally worked out only once read */
+
+    enum FlagOp {
+        Flags_None, Flags_Add, Flags_Adc, Flags_Sub, Flags_Sbc, Flags_And, Flags_Or, Flags_Xor, Flags_Cp,
+        Flags_Inc, Flags_Dec, Flags_Add16, Flags_Adc16, Flags_Sbc16
+    };
+
+    // Flags each operation writes, the rest of F is left as it was
+    static const uint8_t flagMask[];
+
+    uint8_t computeFlags(uint8_t op, uint16_t a, uint16_t b, uint8_t c);
+    void updateFlags(uint8_t op, uint16_t a, uint16_t b, uint8_t c = 0);
+    inline void flushFlags();
+
+#ifdef Z80_LAZY_FLAGS
+    // Operands of the last operation whose flags are not in F yet
+    uint8_t lazyOp;
+    uint16_t lazyA;
+    uint16_t lazyB;
+    uint8_t lazyCarry;
+
+    void materialiseFlags();
+#endif
+
+#ifdef Z80_PROFILE
+    void profileInstruction(const uint8_t* byte, int res);
+#endif
+
     // Helper
     void incrementPC(int val);
 
-    uint8_t read_rrrSymbol(uint8_t rrr);
-    void write_rrrSymbol(uint8_t rrr, uint8_t data);
+    // Registers selected by each operand field, indexed by the decoded bits
+    static const uint8_t rrrRegister[8];
+    uint16_t* ddPair[4];
+    uint16_t* qqPair[4];
+    uint16_t* ppPair[4];
+    uint16_t* rrPair[4];
+
+    inline uint8_t read_rrrSymbol(uint8_t rrr);
+    inline void write_rrrSymbol(uint8_t rrr, uint8_t data);
     const char* name_rrrSymbol(uint8_t rrr);
 
-    uint16_t read_ddSymbol(uint8_t dd);
-    void write_ddSymbol(uint8_t dd, uint16_t data);
+    inline uint16_t read_ddSymbol(uint8_t dd);
+    inline void write_ddSymbol(uint8_t dd, uint16_t data);
     const char* name_ddSymbol(uint8_t dd);
 
-    uint16_t read_ssSymbol(uint8_t ss);
-    void write_ssSymbol(uint8_t ss, uint16_t data);
+    inline uint16_t read_ssSymbol(uint8_t ss);
+    inline void write_ssSymbol(uint8_t ss, uint16_t data);
     const char* name_ssSymbol(uint8_t ss);
 
-    uint16_t read_qqSymbol(uint8_t qq);
-    void write_qqSymbol(uint8_t qq, uint16_t data);
+    inline uint16_t read_qqSymbol(uint8_t qq);
+    inline void write_qqSymbol(uint8_t qq, uint16_t data);
     const char* name_qqSymbol(uint8_t qq);
 
-    uint16_t read_ppSymbol(uint8_t pp);
-    void write_ppSymbol(uint8_t pp, uint16_t data);
+    inline uint16_t read_ppSymbol(uint8_t pp);
+    inline void write_ppSymbol(uint8_t pp, uint16_t data);
     const char* name_ppSymbol(uint8_t pp);
 
-    uint16_t read_rrSymbol(uint8_t rr);
-    void write_rrSymbol(uint8_t rr, uint16_t data);
+    inline uint16_t read_rrSymbol(uint8_t rr);
+    inline void write_rrSymbol(uint8_t rr, uint16_t data);
     const char* name_rrSymbol(uint8_t rr);
 
     bool read_cccSymbol(uint8_t ccc);
     const char* name_cccSymbol(uint8_t ccc);
 };
 
+/* Operand fields, inline as every instruction group decodes through them */
+
+inline void Z80::flushFlags() {
+#ifdef Z80_LAZY_FLAGS
+    if(lazyOp != Flags_None)
+        materialiseFlags();
+#endif
+}
+
+inline uint8_t Z80::read_rrrSymbol(uint8_t rrr) {
+
+    if((rrr & 0b111) == 6)
+        flushFlags();
+
+    return reg[rrrRegister[rrr & 0b111]];
+}
+
+inline void Z80::write_rrrSymbol(uint8_t rrr, uint8_t data) {
+
+    if((rrr & 0b111) == 6)
+        flushFlags();
+
+    reg[rrrRegister[rrr & 0b111]] = data;
+}
+
+inline uint16_t Z80::read_ddSymbol(uint8_t dd) {
+    return *ddPair[dd & 0b11];
+}
+
+inline void Z80::write_ddSymbol(uint8_t dd, uint16_t data) {
+    *ddPair[dd & 0b11] = data;
+}
+
+inline uint16_t Z80::read_ssSymbol(uint8_t ss) {
+    return *ddPair[ss & 0b11];
+}
+
+inline void Z80::write_ssSymbol(uint8_t ss, uint16_t data) {
+    *ddPair[ss & 0b11] = data;
+}
+
+inline uint16_t Z80::read_qqSymbol(uint8_t qq) {
+    flushFlags();
+    return *qqPair[qq & 0b11];
+}
+
+inline void Z80::write_qqSymbol(uint8_t qq, uint16_t data) {
+    flushFlags();
+    *qqPair[qq & 0b11] = data;
+}
+
+inline uint16_t Z80::read_ppSymbol(uint8_t pp) {
+    return *ppPair[pp & 0b11];
+}
+
+inline void Z80::write_ppSymbol(uint8_t pp, uint16_t data) {
+    *ppPair[pp & 0b11] = data;
+}
+
+inline uint16_t Z80::read_rrSymbol(uint8_t rr) {
+    return *rrPair[rr & 0b11];
+}
+
+inline void Z80::write_rrSymbol(uint8_t rr, uint16_t data) {
+    *rrPair[rr & 0b11] = data;
+}
+
 #endif
\ No newline at end of file